@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../bid_generation.h"
+
+/*
+ * Run Commands:
+ * g++ -std=c++11 -m64 -O2 -march=native -pthread best_vehicle_benchmark.cpp -o best_vehicle_benchmark
+ * ./best_vehicle_benchmark
+ *
+ * Microbenchmark of best-vehicle selection for pair bids (consider_only_best_bid mode):
+ * the original unordered_map<int, Vehicle> loop versus the scalar and AVX2 kernels over the distance tables
+ * (depot rows in capacity bucket order, scanning only the vehicles able to carry the pair) and the depot grid search
+ * (used for the pairs where generate_pair_bids would use it, the kernel otherwise)
+ */
+
+struct BenchmarkVehicle {
+	std::pair<int, int> depot_location;
+	int capacity;
+	int id;
+};
+
+const int GRID_SIZE_X = 200;
+const int GRID_SIZE_Y = 300;
+const int NUM_TARGETS = 200;
+const int MIN_CAPACITY = 80;
+const int MAX_CAPACITY = 140;
+const int MAX_WEIGHT = 68;
+
+// Tour length the original loop assigned to vehicles that cannot carry the pair
+const double INFEASIBLE_TOUR_LENGTH = std::numeric_limits<float>::max();
+
+// Sink that keeps the optimizer from discarding benchmark results
+double checksum = 0;
+
+/*
+ * Original best-bid pair loop: iterate the vehicle map, copy each vehicle, build the bid name and compute three distances
+ */
+double legacy_best_pair_vehicles(std::unordered_map<int, BenchmarkVehicle>& vehicles, std::pair<int, int> location_1, std::pair<int, int> location_2,
+								 int target_id_1, int target_id_2, int pair_weight, std::vector<int>& best_bids_vehicle_ids) {
+	std::vector<std::string> best_bids_var_names;
+	best_bids_vehicle_ids.clear();
+	double min_tour_length = -1;
+
+	for (const auto& vehicle_entry : vehicles) {
+		BenchmarkVehicle vehicle = vehicle_entry.second;
+		std::string var_name = std::to_string(vehicle.id) + "," + std::to_string(target_id_1) + "," + std::to_string(target_id_2);
+		double tour_length = euclidean_distance(location_1, location_2)
+							+ euclidean_distance(location_1, vehicle.depot_location)
+							+ euclidean_distance(location_2, vehicle.depot_location);
+
+		if (pair_weight > vehicle.capacity) {
+			tour_length = INFEASIBLE_TOUR_LENGTH;
+		}
+
+		if (tour_length < min_tour_length || min_tour_length == -1) {
+			best_bids_var_names.clear();
+			best_bids_vehicle_ids.clear();
+			best_bids_var_names.push_back(var_name);
+			best_bids_vehicle_ids.push_back(vehicle.id);
+			min_tour_length = tour_length;
+		} else if (tour_length == min_tour_length) {
+			best_bids_var_names.push_back(var_name);
+			best_bids_vehicle_ids.push_back(vehicle.id);
+		}
+	}
+
+	return min_tour_length;
+}
+
+/*
+ * Run one benchmark configuration with the given number of vehicles and print nanoseconds per target pair
+ */
+void run_benchmark(int num_vehicles) {
+	std::vector<std::pair<int, int>> target_locations;
+	std::vector<int> weights;
+	std::vector<std::pair<int, int>> depot_locations;
+	std::vector<int> capacities;
+	std::unordered_map<int, BenchmarkVehicle> vehicles;
+
+	for (int i = 0; i < NUM_TARGETS; i++) {
+		target_locations.push_back(std::make_pair(rand() % (GRID_SIZE_X + 1), rand() % (GRID_SIZE_Y + 1)));
+		weights.push_back(rand() % MAX_WEIGHT + 1);
+	}
+
+	for (int i = 0; i < num_vehicles; i++) {
+		int capacity = rand() % (MAX_CAPACITY - MIN_CAPACITY + 1) + MIN_CAPACITY;
+		BenchmarkVehicle vehicle = {std::make_pair(rand() % (GRID_SIZE_X + 1), rand() % (GRID_SIZE_Y + 1)), capacity, i};
+		depot_locations.push_back(vehicle.depot_location);
+		capacities.push_back(vehicle.capacity);
+		vehicles.insert(std::make_pair(i, vehicle));
+	}
+
+	CapacityBuckets buckets;
+	build_capacity_buckets(capacities, buckets);
+	std::vector<std::pair<int, int>> slot_depot_locations;
+	for (int slot = 0; slot < num_vehicles; slot++) {
+		slot_depot_locations.push_back(depot_locations[buckets.vehicle_order[slot]]);
+	}
+
+	DistanceTables tables;
+	build_distance_tables(tables, target_locations, slot_depot_locations);
+	SpatialGrid depot_grid;
+	build_spatial_grid(depot_grid, slot_depot_locations);
+	std::vector<int> grid_vehicle_slots;
+	std::vector<int> best_vehicle_slots;
+	std::vector<int> best_vehicle_ids;
+	std::vector<int> reference_vehicle_ids;
+	long long num_pairs = 0;
+	int mismatches = 0;
+
+	// Correctness: kernels must agree with the original loop on cost and the set of tied vehicles
+	for (int target_id_1 = 0; target_id_1 < NUM_TARGETS - 1; target_id_1++) {
+		for (int target_id_2 = target_id_1 + 1; target_id_2 < NUM_TARGETS; target_id_2++) {
+			int pair_weight = weights[target_id_1] + weights[target_id_2];
+			double reference = legacy_best_pair_vehicles(vehicles, target_locations[target_id_1], target_locations[target_id_2],
+														 target_id_1, target_id_2, pair_weight, reference_vehicle_ids);
+			int num_feasible_vehicles = feasible_vehicle_count(buckets, pair_weight);
+
+			// Pairs no vehicle can carry produce no bid at all
+			if (num_feasible_vehicles == 0) {
+				mismatches += reference != INFEASIBLE_TOUR_LENGTH;
+			} else {
+				double result = best_pair_vehicles(target_depot_row(tables, target_id_1), target_depot_row(tables, target_id_2),
+												   target_target_distance(tables, target_id_1, target_id_2), num_feasible_vehicles,
+												   best_vehicle_slots);
+				best_vehicle_ids.clear();
+				for (int slot : best_vehicle_slots) {
+					best_vehicle_ids.push_back(buckets.vehicle_order[slot]);
+				}
+				std::sort(best_vehicle_ids.begin(), best_vehicle_ids.end());
+				std::sort(reference_vehicle_ids.begin(), reference_vehicle_ids.end());
+				if (result != reference || best_vehicle_ids != reference_vehicle_ids) {
+					mismatches++;
+				}
+
+				// Grid search must return exactly the kernel's slots
+				double grid_result = best_pair_vehicles_grid(depot_grid, target_locations[target_id_1], target_locations[target_id_2],
+															 target_depot_row(tables, target_id_1), target_depot_row(tables, target_id_2),
+															 target_target_distance(tables, target_id_1, target_id_2), num_feasible_vehicles,
+															 grid_vehicle_slots);
+				if (grid_result != result || grid_vehicle_slots != best_vehicle_slots) {
+					mismatches++;
+				}
+			}
+			num_pairs++;
+		}
+	}
+
+	// Timing
+	double timings[4];
+	for (int variant = 0; variant < 4; variant++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int target_id_1 = 0; target_id_1 < NUM_TARGETS - 1; target_id_1++) {
+			for (int target_id_2 = target_id_1 + 1; target_id_2 < NUM_TARGETS; target_id_2++) {
+				int pair_weight = weights[target_id_1] + weights[target_id_2];
+				int num_feasible_vehicles = feasible_vehicle_count(buckets, pair_weight);
+				const double* depot_distances_1 = target_depot_row(tables, target_id_1);
+				const double* depot_distances_2 = target_depot_row(tables, target_id_2);
+				double targets_distance = target_target_distance(tables, target_id_1, target_id_2);
+
+				if (variant == 0) {
+					checksum += legacy_best_pair_vehicles(vehicles, target_locations[target_id_1], target_locations[target_id_2],
+														  target_id_1, target_id_2, pair_weight, best_vehicle_slots);
+				} else if (num_feasible_vehicles == 0) {
+					best_vehicle_slots.clear();
+				} else if (variant == 1) {
+					checksum += best_pair_vehicles_scalar(depot_distances_1, depot_distances_2, targets_distance,
+														  num_feasible_vehicles, best_vehicle_slots);
+				} else if (variant == 3 && grid_expected_points_within(depot_grid, 0.5 * targets_distance) * BID_GRID_PAIR_SCAN_RATIO
+										   < num_feasible_vehicles) {
+					checksum += best_pair_vehicles_grid(depot_grid, target_locations[target_id_1], target_locations[target_id_2],
+														depot_distances_1, depot_distances_2, targets_distance,
+														num_feasible_vehicles, best_vehicle_slots);
+				} else {
+					checksum += best_pair_vehicles(depot_distances_1, depot_distances_2, targets_distance,
+												   num_feasible_vehicles, best_vehicle_slots);
+				}
+				checksum += best_vehicle_slots.size();
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		timings[variant] = std::chrono::duration<double, std::nano>(end - start).count() / num_pairs;
+	}
+
+	printf("%6d %14.1f %14.1f %14.1f %14.1f %10.1fx %10d\n", num_vehicles, timings[0], timings[1], timings[2], timings[3],
+		   timings[0] / std::min(timings[2], timings[3]), mismatches);
+}
+
+int main() {
+#ifdef __AVX2__
+	const char* kernel_name = "avx2";
+#else
+	const char* kernel_name = "scalar";
+#endif
+	printf("Best-vehicle kernel benchmark (%d targets, dispatch = %s), ns per target pair\n", NUM_TARGETS, kernel_name);
+	printf("%6s %14s %14s %14s %14s %11s %10s\n", "V", "original loop", "scalar kernel", "kernel", "depot grid", "speedup", "mismatches");
+
+	int vehicle_counts[] = {6, 64, 512, 4096};
+	for (int num_vehicles : vehicle_counts) {
+		run_benchmark(num_vehicles);
+	}
+
+	fprintf(stderr, "checksum %f\n", checksum);
+}
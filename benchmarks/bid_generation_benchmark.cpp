@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../bid_generation.h"
+#include "../instance.h"
+
+/*
+ * Run Commands:
+ * g++ -std=c++11 -m64 -O2 -march=native -pthread bid_generation_benchmark.cpp -o bid_generation_benchmark
+ * ./bid_generation_benchmark
+ *
+ * Benchmark of best-bid generation per instance (serial), from the instance representation to the bid list:
+ * the original loop over unordered_map<int, Target/Vehicle> (copying each entry and looking targets up by hash in the
+ * O(T^2) loop), the same instance maps gathered into the dense tables of generate_bids, and the structure-of-arrays
+ * Instance gathered into the same tables
+ */
+
+struct BenchmarkTarget {
+	std::pair<int, int> location;
+	int weight;
+	int id;
+};
+
+struct BenchmarkVehicle {
+	std::pair<int, int> depot_location;
+	int capacity;
+	int id;
+};
+
+const int GRID_SIZE_X = 200;
+const int GRID_SIZE_Y = 300;
+const int MIN_CAPACITY = 80;
+const int MAX_CAPACITY = 140;
+const int MAX_WEIGHT = 68;
+const int NUM_ROUNDS = 5;
+
+// Sink that keeps the optimizer from discarding benchmark results
+double checksum = 0;
+
+/*
+ * Original best-bid generation: iterate the target and vehicle maps, copying each entry, with hash lookups per pair
+ */
+void legacy_map_bids(std::unordered_map<int, BenchmarkTarget>& targets, std::unordered_map<int, BenchmarkVehicle>& vehicles,
+					 const std::vector<int>& target_ids, std::vector<BidRecord>& bids) {
+	bids.clear();
+	for (const auto& target_entry : targets) {
+		BenchmarkTarget target = target_entry.second;
+		BidRecord best_bid = {-1, -1, target.id, -1};
+		for (const auto& vehicle_entry : vehicles) {
+			BenchmarkVehicle vehicle = vehicle_entry.second;
+			double tour_length = 2 * euclidean_distance(target.location, vehicle.depot_location);
+			if (target.weight <= vehicle.capacity && (best_bid.vehicle_id == -1 || tour_length < best_bid.tour_length)) {
+				best_bid.tour_length = tour_length;
+				best_bid.vehicle_id = vehicle.id;
+			}
+		}
+		if (best_bid.vehicle_id != -1) {
+			bids.push_back(best_bid);
+		}
+	}
+
+	for (int target_id_1 : target_ids) {
+		for (int target_id_2 : target_ids) {
+			if (target_id_1 >= target_id_2) {
+				continue;
+			}
+			BenchmarkTarget target_1 = targets[target_id_1];
+			BenchmarkTarget target_2 = targets[target_id_2];
+			BidRecord best_bid = {-1, -1, target_id_1, target_id_2};
+			for (const auto& vehicle_entry : vehicles) {
+				BenchmarkVehicle vehicle = vehicle_entry.second;
+				double tour_length = euclidean_distance(target_1.location, target_2.location)
+									+ euclidean_distance(target_1.location, vehicle.depot_location)
+									+ euclidean_distance(target_2.location, vehicle.depot_location);
+				if (target_1.weight + target_2.weight <= vehicle.capacity && (best_bid.vehicle_id == -1 || tour_length < best_bid.tour_length)) {
+					best_bid.tour_length = tour_length;
+					best_bid.vehicle_id = vehicle.id;
+				}
+			}
+			if (best_bid.vehicle_id != -1) {
+				bids.push_back(best_bid);
+			}
+		}
+	}
+}
+
+/*
+ * Build the dense tables from gathered locations, weights and capacities and generate the best bids
+ */
+void table_bids(const std::vector<std::pair<int, int>>& target_locations, const std::vector<std::pair<int, int>>& depot_locations,
+				const std::vector<int>& weights, const std::vector<int>& capacities, std::vector<BidRecord>& bids) {
+	CapacityBuckets buckets;
+	build_capacity_buckets(capacities, buckets);
+	std::vector<std::pair<int, int>> slot_depot_locations(depot_locations.size());
+	for (size_t slot = 0; slot < depot_locations.size(); slot++) {
+		slot_depot_locations[slot] = depot_locations[buckets.vehicle_order[slot]];
+	}
+
+	DistanceTables tables;
+	build_distance_tables(tables, target_locations, slot_depot_locations);
+	generate_bids(true, tables, weights, buckets, NULL, NULL, 1, bids);
+}
+
+/*
+ * Previous representation: instance maps gathered into dense arrays, then the table-based bid generation
+ */
+void map_instance_bids(const std::vector<std::pair<int, int>>& locations, const std::vector<int>& weights,
+					   const std::vector<std::pair<int, int>>& depots, const std::vector<int>& capacities, std::vector<BidRecord>& bids) {
+	std::unordered_map<int, BenchmarkTarget> targets;
+	std::unordered_map<int, BenchmarkVehicle> vehicles;
+	for (size_t i = 0; i < locations.size(); i++) {
+		BenchmarkTarget target = {locations[i], weights[i], (int) i};
+		targets.insert(std::make_pair(target.id, target));
+	}
+	for (size_t i = 0; i < depots.size(); i++) {
+		BenchmarkVehicle vehicle = {depots[i], capacities[i], (int) i};
+		vehicles.insert(std::make_pair(vehicle.id, vehicle));
+	}
+
+	std::vector<std::pair<int, int>> target_locations(targets.size());
+	std::vector<std::pair<int, int>> depot_locations(vehicles.size());
+	std::vector<int> target_weights(targets.size());
+	std::vector<int> vehicle_capacities(vehicles.size());
+	for (const auto& target_entry : targets) {
+		target_locations[target_entry.first] = target_entry.second.location;
+		target_weights[target_entry.first] = target_entry.second.weight;
+	}
+	for (const auto& vehicle_entry : vehicles) {
+		depot_locations[vehicle_entry.first] = vehicle_entry.second.depot_location;
+		vehicle_capacities[vehicle_entry.first] = vehicle_entry.second.capacity;
+	}
+
+	table_bids(target_locations, depot_locations, target_weights, vehicle_capacities, bids);
+}
+
+/*
+ * Structure-of-arrays representation: Instance arrays used directly, locations gathered once
+ */
+void soa_instance_bids(const std::vector<std::pair<int, int>>& locations, const std::vector<int>& weights,
+					   const std::vector<std::pair<int, int>>& depots, const std::vector<int>& capacities, std::vector<BidRecord>& bids) {
+	Instance instance;
+	reserve_instance(instance, locations.size(), depots.size());
+	for (size_t i = 0; i < locations.size(); i++) {
+		add_target(instance, locations[i], weights[i]);
+	}
+	for (size_t i = 0; i < depots.size(); i++) {
+		add_vehicle(instance, depots[i], capacities[i]);
+	}
+
+	std::vector<std::pair<int, int>> target_locations;
+	gather_target_locations(instance, target_locations);
+	std::vector<std::pair<int, int>> depot_locations(vehicle_count(instance));
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+		depot_locations[vehicle_id] = vehicle_location(instance, vehicle_id);
+	}
+
+	table_bids(target_locations, depot_locations, instance.target_weight, instance.vehicle_capacity, bids);
+}
+
+/*
+ * Run one benchmark configuration and print microseconds per instance
+ */
+void run_benchmark(int num_targets, int num_vehicles, int num_instances) {
+	std::vector<std::vector<std::pair<int, int>>> locations(num_instances);
+	std::vector<std::vector<int>> weights(num_instances);
+	std::vector<std::vector<std::pair<int, int>>> depots(num_instances);
+	std::vector<std::vector<int>> capacities(num_instances);
+	for (int instance = 0; instance < num_instances; instance++) {
+		for (int i = 0; i < num_targets; i++) {
+			locations[instance].push_back(std::make_pair(rand() % (GRID_SIZE_X + 1), rand() % (GRID_SIZE_Y + 1)));
+			weights[instance].push_back(rand() % MAX_WEIGHT + 1);
+		}
+		for (int i = 0; i < num_vehicles; i++) {
+			depots[instance].push_back(std::make_pair(rand() % (GRID_SIZE_X + 1), rand() % (GRID_SIZE_Y + 1)));
+			capacities[instance].push_back(rand() % (MAX_CAPACITY - MIN_CAPACITY + 1) + MIN_CAPACITY);
+		}
+	}
+
+	// Correctness: both table paths must generate the same bids
+	int mismatches = 0;
+	std::vector<BidRecord> map_bids;
+	std::vector<BidRecord> soa_bids;
+	for (int instance = 0; instance < num_instances; instance++) {
+		map_instance_bids(locations[instance], weights[instance], depots[instance], capacities[instance], map_bids);
+		soa_instance_bids(locations[instance], weights[instance], depots[instance], capacities[instance], soa_bids);
+		bool same = map_bids.size() == soa_bids.size();
+		for (size_t i = 0; same && i < map_bids.size(); i++) {
+			same = map_bids[i].tour_length == soa_bids[i].tour_length && map_bids[i].vehicle_id == soa_bids[i].vehicle_id
+				   && map_bids[i].target_id_1 == soa_bids[i].target_id_1 && map_bids[i].target_id_2 == soa_bids[i].target_id_2;
+		}
+		mismatches += !same;
+	}
+
+	// Timing (best of several rounds, variants interleaved)
+	double timings[3] = {1e300, 1e300, 1e300};
+	std::vector<BidRecord> bids;
+	for (int round = 0; round < 3 * NUM_ROUNDS; round++) {
+		int variant = round % 3;
+		auto start = std::chrono::steady_clock::now();
+		for (int instance = 0; instance < num_instances; instance++) {
+			if (variant == 0) {
+				std::unordered_map<int, BenchmarkTarget> targets;
+				std::unordered_map<int, BenchmarkVehicle> vehicles;
+				std::vector<int> target_ids;
+				for (int i = 0; i < num_targets; i++) {
+					BenchmarkTarget target = {locations[instance][i], weights[instance][i], i};
+					targets.insert(std::make_pair(i, target));
+					target_ids.push_back(i);
+				}
+				for (int i = 0; i < num_vehicles; i++) {
+					BenchmarkVehicle vehicle = {depots[instance][i], capacities[instance][i], i};
+					vehicles.insert(std::make_pair(i, vehicle));
+				}
+				legacy_map_bids(targets, vehicles, target_ids, bids);
+			} else if (variant == 1) {
+				map_instance_bids(locations[instance], weights[instance], depots[instance], capacities[instance], bids);
+			} else {
+				soa_instance_bids(locations[instance], weights[instance], depots[instance], capacities[instance], bids);
+			}
+			checksum += bids.size();
+		}
+		auto end = std::chrono::steady_clock::now();
+		timings[variant] = std::min(timings[variant], std::chrono::duration<double, std::micro>(end - start).count() / num_instances);
+	}
+
+	printf("%6d %6d %14.2f %14.2f %14.2f %10.2fx %10.2fx %10d\n", num_targets, num_vehicles, timings[0], timings[1], timings[2],
+		   timings[0] / timings[2], timings[1] / timings[2], mismatches);
+}
+
+int main() {
+	printf("Best-bid generation benchmark (serial), us per instance\n");
+	printf("%6s %6s %14s %14s %14s %11s %11s %10s\n", "T", "V", "original maps", "maps + tables", "SoA + tables", "vs orig", "vs maps",
+		   "mismatches");
+
+	// Data set sized instances, then larger ones
+	run_benchmark(10, 6, 20000);
+	run_benchmark(100, 10, 500);
+	run_benchmark(200, 64, 50);
+	run_benchmark(1000, 16, 5);
+
+	fprintf(stderr, "checksum %f\n", checksum);
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../distance_tables.h"
+
+/*
+ * Run Commands:
+ * g++ -std=c++11 -m64 -O2 -march=native distance_oracle_benchmark.cpp -o distance_oracle_benchmark
+ * ./distance_oracle_benchmark
+ *
+ * Benchmark of the distance oracle on the data set grid (200 x 300):
+ * building the distance tables with computed square roots versus the (|dx|, |dy|) offset table, and selecting the
+ * nearest depot of each target by comparing square roots versus squared integer distances
+ */
+
+const int GRID_SIZE_X = 200;
+const int GRID_SIZE_Y = 300;
+const int NUM_ROUNDS = 5;
+
+// Sink that keeps the optimizer from discarding benchmark results
+double checksum = 0;
+
+/*
+ * Return random locations on the grid
+ */
+std::vector<std::pair<int, int>> random_locations(int num_locations) {
+	std::vector<std::pair<int, int>> locations;
+	for (int i = 0; i < num_locations; i++) {
+		locations.push_back(std::make_pair(rand() % (GRID_SIZE_X + 1), rand() % (GRID_SIZE_Y + 1)));
+	}
+	return locations;
+}
+
+/*
+ * Time the distance table build with and without the offset table and print microseconds per build
+ */
+void run_table_benchmark(int num_targets, int num_vehicles) {
+	std::vector<std::pair<int, int>> target_locations = random_locations(num_targets);
+	std::vector<std::pair<int, int>> depot_locations = random_locations(num_vehicles);
+	distance_oracle_max_entries = 1 << 20;
+	DistanceOracle oracle;
+	cover_locations(oracle, target_locations, depot_locations);
+
+	// Correctness: both builds must store the same distances
+	DistanceTables computed_tables;
+	DistanceTables oracle_tables;
+	build_distance_tables(computed_tables, target_locations, depot_locations, true, NULL);
+	build_distance_tables(oracle_tables, target_locations, depot_locations, true, &oracle);
+	bool same = computed_tables.target_target == oracle_tables.target_target && computed_tables.target_depot == oracle_tables.target_depot;
+
+	// Timing (best of several rounds, variants interleaved)
+	long long num_distances = (long long) num_targets * (num_targets - 1) / 2 + (long long) num_targets * num_vehicles;
+	int repetitions = std::max(1LL, 20000000 / num_distances);
+	double timings[2] = {1e300, 1e300};
+	for (int round = 0; round < 2 * NUM_ROUNDS; round++) {
+		int variant = round % 2;
+		auto start = std::chrono::steady_clock::now();
+		for (int repetition = 0; repetition < repetitions; repetition++) {
+			DistanceTables tables;
+			build_distance_tables(tables, target_locations, depot_locations, true, variant == 0 ? NULL : &oracle);
+			checksum += tables.target_depot.back();
+		}
+		auto end = std::chrono::steady_clock::now();
+		timings[variant] = std::min(timings[variant], std::chrono::duration<double, std::micro>(end - start).count() / repetitions);
+	}
+
+	printf("%-16s %6d %6d %14.2f %14.2f %10.2fx %10s\n", "table build", num_targets, num_vehicles, timings[0], timings[1],
+		   timings[0] / timings[1], same ? "same" : "DIFFERENT");
+}
+
+/*
+ * Time nearest-depot selection with square roots and with squared distances and print microseconds per instance
+ */
+void run_argmin_benchmark(int num_targets, int num_vehicles) {
+	std::vector<std::pair<int, int>> target_locations = random_locations(num_targets);
+	std::vector<int> depot_x;
+	std::vector<int> depot_y;
+	for (const std::pair<int, int>& location : random_locations(num_vehicles)) {
+		depot_x.push_back(location.first);
+		depot_y.push_back(location.second);
+	}
+
+	// Correctness: both selections must pick the same depot
+	int mismatches = 0;
+	std::vector<int> nearest(2 * num_targets);
+	double timings[2] = {1e300, 1e300};
+	int repetitions = std::max(1, 20000000 / (num_targets * num_vehicles));
+	for (int round = 0; round < 2 * NUM_ROUNDS; round++) {
+		int variant = round % 2;
+		auto start = std::chrono::steady_clock::now();
+		for (int repetition = 0; repetition < repetitions; repetition++) {
+			for (int target_id = 0; target_id < num_targets; target_id++) {
+				std::pair<int, int> location = target_locations[target_id];
+				int nearest_vehicle = 0;
+				if (variant == 0) {
+					double shortest_distance = -1;
+					for (int vehicle_id = 0; vehicle_id < num_vehicles; vehicle_id++) {
+						double distance = euclidean_distance(location, std::make_pair(depot_x[vehicle_id], depot_y[vehicle_id]));
+						if (shortest_distance < 0 || distance < shortest_distance) {
+							nearest_vehicle = vehicle_id;
+							shortest_distance = distance;
+						}
+					}
+				} else {
+					nearest_vehicle = nearest_point_index(location, depot_x.data(), depot_y.data(), num_vehicles);
+				}
+				nearest[variant * num_targets + target_id] = nearest_vehicle;
+				checksum += nearest_vehicle;
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		timings[variant] = std::min(timings[variant], std::chrono::duration<double, std::micro>(end - start).count() / repetitions);
+	}
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		mismatches += nearest[target_id] != nearest[num_targets + target_id];
+	}
+
+	printf("%-16s %6d %6d %14.2f %14.2f %10.2fx %10d\n", "nearest depot", num_targets, num_vehicles, timings[0], timings[1],
+		   timings[0] / timings[1], mismatches);
+}
+
+int main() {
+	printf("Distance oracle benchmark (%d x %d grid), us per instance\n", GRID_SIZE_X, GRID_SIZE_Y);
+	printf("%-16s %6s %6s %14s %14s %11s %10s\n", "", "T", "V", "square roots", "oracle", "speedup", "mismatches");
+
+	int target_counts[] = {10, 200, 2000};
+	for (int num_targets : target_counts) {
+		run_table_benchmark(num_targets, 16);
+	}
+
+	int vehicle_counts[] = {6, 64, 512};
+	for (int num_vehicles : vehicle_counts) {
+		run_argmin_benchmark(1000, num_vehicles);
+	}
+
+	fprintf(stderr, "checksum %f\n", checksum);
+}
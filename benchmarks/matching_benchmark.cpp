@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../matching_backend.h"
+
+/*
+ * Run Commands:
+ * g++ -std=c++11 -m64 -O2 -march=native -pthread matching_benchmark.cpp -o matching_benchmark -I../include/ -L../lib -lgurobi_c++ -lgurobi95 -lm
+ * ./matching_benchmark [--no-gurobi]
+ * (--no-gurobi skips the MIP solves, but the binary still links against Gurobi, so the libraries above are needed to
+ * build it either way)
+ *
+ * Benchmark of the matching backend against the Gurobi MIP on the same (best bid, dominance-pruned) bid columns:
+ * the bundled datasets, then generated instances of up to 10k targets. Instances up to 2000 targets bid on all pairs;
+ * larger ones use the k-nearest-neighbour candidate pairs (k = 10), since all pairs would not fit in memory.
+ */
+
+struct BenchmarkInstance {
+	std::vector<std::pair<int, int>> target_locations;
+	std::vector<int> weights;
+	std::vector<std::pair<int, int>> depot_locations;
+	std::vector<int> capacities;
+};
+
+const int KNN_TARGET_THRESHOLD = 2000;
+const int KNN_NEIGHBOURS = 10;
+
+/*
+ * Build the bid columns of an instance
+ */
+void build_columns(const BenchmarkInstance& instance, BidColumns& columns) {
+	int num_targets = instance.target_locations.size();
+	CapacityBuckets buckets;
+	build_capacity_buckets(instance.capacities, buckets);
+	std::vector<std::pair<int, int>> slot_depot_locations;
+	for (int vehicle_id : buckets.vehicle_order) {
+		slot_depot_locations.push_back(instance.depot_locations[vehicle_id]);
+	}
+
+	bool use_knn = num_targets > KNN_TARGET_THRESHOLD;
+	DistanceTables tables;
+	build_distance_tables(tables, instance.target_locations, slot_depot_locations, !use_knn);
+	CandidatePairs candidate_pairs;
+	if (use_knn) {
+		build_knn_candidate_pairs(instance.target_locations, KNN_NEIGHBOURS, candidate_pairs);
+	}
+
+	std::vector<BidRecord> bids;
+	generate_bids(true, tables, instance.weights, buckets, NULL, use_knn ? &candidate_pairs : NULL, 0, bids);
+	PruningStats pruning_stats;
+	prune_dominated_pair_bids(num_targets, bids, pruning_stats);
+	collect_bid_columns(bids, num_targets, columns);
+}
+
+/*
+ * Solve the columns with the Gurobi MIP and return the objective and solve time
+ */
+double solve_with_gurobi(GRBEnv& environment, const BidColumns& columns, double& seconds) {
+	auto start = std::chrono::steady_clock::now();
+	GRBModel model = GRBModel(environment);
+	std::vector<GRBVar> bid_vars;
+	std::vector<GRBConstr> cover_constrs;
+	add_bid_variables(model, columns, false, bid_vars);
+	add_cover_constraints(model, columns, bid_vars, cover_constrs);
+	model.optimize();
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return model.get(GRB_DoubleAttr_ObjVal);
+}
+
+/*
+ * Run both solvers on an instance and print one result line
+ */
+void run_instance(const std::string& name, const BenchmarkInstance& instance, GRBEnv* environment, double& matching_total, double& gurobi_total, int& mismatches) {
+	BidColumns columns;
+	build_columns(instance, columns);
+	int num_targets = instance.target_locations.size();
+
+	CvrpSolution solution;
+	MatchingStats stats;
+	solve_cover_by_matching(columns, num_targets, instance.depot_locations.size(), solution, stats);
+	matching_total += stats.solve_seconds;
+
+	double gurobi_objective = -1;
+	double gurobi_seconds = 0;
+	if (environment != NULL) {
+		gurobi_objective = solve_with_gurobi(*environment, columns, gurobi_seconds);
+		gurobi_total += gurobi_seconds;
+		if (std::fabs(gurobi_objective - solution.objective) > 1e-4 * std::max(1.0, solution.objective)) {
+			mismatches++;
+		}
+	}
+
+	printf("%-16s %7d %10d %9d %10d %16.4f %12.4f %16.4f %12.4f\n", name.c_str(), num_targets, (int) columns.tour_lengths.size(),
+		   stats.num_edges, stats.largest_component, solution.objective, stats.solve_seconds, gurobi_objective, gurobi_seconds);
+}
+
+/*
+ * Read the bundled datasets (capacity 100 per vehicle, as in generate_instance)
+ */
+std::vector<BenchmarkInstance> read_datasets(const std::string& input_file_name) {
+	std::vector<BenchmarkInstance> instances;
+	std::ifstream infile(input_file_name);
+	std::string name_line, vehicles_line, targets_line, weights_line;
+
+	while (std::getline(infile, name_line) && std::getline(infile, vehicles_line) && std::getline(infile, targets_line) && std::getline(infile, weights_line)) {
+		BenchmarkInstance instance;
+		std::string token;
+		std::stringstream vehicle_stream(vehicles_line.substr(vehicles_line.find(':') + 1));
+		while (std::getline(vehicle_stream, token, ';')) {
+			int x, y;
+			if (sscanf(token.c_str(), "%d,%d", &x, &y) == 2) {
+				instance.depot_locations.push_back(std::make_pair(x, y));
+				instance.capacities.push_back(100);
+			}
+		}
+
+		std::stringstream target_stream(targets_line.substr(targets_line.find(':') + 1));
+		while (std::getline(target_stream, token, ';')) {
+			int x, y;
+			if (sscanf(token.c_str(), "%d,%d", &x, &y) == 2) {
+				instance.target_locations.push_back(std::make_pair(x, y));
+			}
+		}
+
+		std::stringstream weight_stream(weights_line.substr(weights_line.find('=') + 1));
+		while (std::getline(weight_stream, token, ',')) {
+			instance.weights.push_back(atoi(token.c_str()));
+		}
+
+		instances.push_back(instance);
+	}
+
+	return instances;
+}
+
+/*
+ * Generate a random instance (grid scaled with the number of targets, weights 10-100, capacities 100-500)
+ */
+BenchmarkInstance random_instance(int num_targets, int num_vehicles) {
+	BenchmarkInstance instance;
+	int grid_size = 20 * (int) std::sqrt((double) num_targets) + 100;
+	for (int i = 0; i < num_targets; i++) {
+		instance.target_locations.push_back(std::make_pair(rand() % (grid_size + 1), rand() % (grid_size + 1)));
+		instance.weights.push_back(rand() % 91 + 10);
+	}
+
+	for (int i = 0; i < num_vehicles; i++) {
+		instance.depot_locations.push_back(std::make_pair(rand() % (grid_size + 1), rand() % (grid_size + 1)));
+		instance.capacities.push_back(rand() % 401 + 100);
+	}
+
+	return instance;
+}
+
+int main(int argc, char *argv[]) {
+	bool use_gurobi = !(argc > 1 && std::string(argv[1]) == "--no-gurobi");
+	std::unique_ptr<GRBEnv> environment;
+	if (use_gurobi) {
+		environment.reset(new GRBEnv());
+		environment -> set(GRB_IntParam_OutputFlag, 0);
+	}
+
+	printf("%-16s %7s %10s %9s %10s %16s %12s %16s %12s\n", "instance", "targets", "bids", "edges", "component",
+		   "matching obj", "matching s", "gurobi obj", "gurobi s");
+
+	// Bundled datasets
+	std::vector<BenchmarkInstance> datasets = read_datasets("../CVRP_commondatasets.txt");
+	double matching_total = 0, gurobi_total = 0;
+	int mismatches = 0;
+	for (size_t i = 0; i < datasets.size(); i++) {
+		double matching_seconds = 0, gurobi_seconds = 0;
+		run_instance("dataset " + std::to_string(i + 1), datasets[i], environment.get(), matching_seconds, gurobi_seconds, mismatches);
+		matching_total += matching_seconds;
+		gurobi_total += gurobi_seconds;
+	}
+	printf("Datasets: %d instances, matching %.4f s, gurobi %.4f s, %d objective mismatches\n\n",
+		   (int) datasets.size(), matching_total, gurobi_total, mismatches);
+
+	// Generated instances
+	srand(1);
+	int target_counts[] = {100, 500, 1000, 2000, 5000, 10000};
+	for (int num_targets : target_counts) {
+		double matching_seconds = 0, gurobi_seconds = 0;
+		run_instance("random", random_instance(num_targets, 20), environment.get(), matching_seconds, gurobi_seconds, mismatches);
+	}
+	printf("Total objective mismatches: %d\n", mismatches);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * Best-vehicle selection for pair bids: argmin over vehicles of d(t1,t2) + d(t1,v) + d(t2,v)
+ * The depot distances of each target are stored as one contiguous row per target (structure of arrays over vehicles),
+ * so the kernel streams two rows. Rows are ordered by descending vehicle capacity, so the vehicles able to carry a
+ * pair are always a prefix of the row and the kernel only scans that prefix. The AVX2 path is used when compiled
+ * with -mavx2 / -march=native, otherwise the scalar fallback is used. Both evaluate (d(t1,t2) + d(t1,v)) + d(t2,v)
+ * in the same order as the original bid loop, so costs and ties are bit-identical.
+ */
+
+/*
+ * Scalar best-vehicle kernel
+ * @param depot_distances_1, depot_distances_2 - Depot distance rows of the two targets (indexed by vehicle slot)
+ * @param targets_distance - Distance between the two targets
+ * @param num_vehicles - Number of vehicle slots to scan (must be positive)
+ * @param best_vehicle_slots - Output: all vehicle slots attaining the minimum tour length (ascending)
+ * Return the minimum tour length
+ */
+double best_pair_vehicles_scalar(const double* depot_distances_1, const double* depot_distances_2, double targets_distance,
+								 int num_vehicles, std::vector<int>& best_vehicle_slots) {
+	best_vehicle_slots.clear();
+	double min_tour_length = -1;
+
+	for (int slot = 0; slot < num_vehicles; slot++) {
+		double tour_length = targets_distance + depot_distances_1[slot] + depot_distances_2[slot];
+
+		// New best bid
+		if (tour_length < min_tour_length || min_tour_length == -1) {
+			best_vehicle_slots.clear();
+			best_vehicle_slots.push_back(slot);
+			min_tour_length = tour_length;
+		}
+
+		// Tie for best bid
+		else if (tour_length == min_tour_length) {
+			best_vehicle_slots.push_back(slot);
+		}
+	}
+
+	return min_tour_length;
+}
+
+#ifdef __AVX2__
+/*
+ * AVX2 best-vehicle kernel (same contract as best_pair_vehicles_scalar)
+ * First pass finds the minimum four lanes at a time, second pass collects every lane equal to it
+ */
+double best_pair_vehicles_avx2(const double* depot_distances_1, const double* depot_distances_2, double targets_distance,
+							   int num_vehicles, std::vector<int>& best_vehicle_slots) {
+	if (num_vehicles < 4) {
+		return best_pair_vehicles_scalar(depot_distances_1, depot_distances_2, targets_distance, num_vehicles, best_vehicle_slots);
+	}
+
+	best_vehicle_slots.clear();
+	const __m256d targets_distance_v = _mm256_set1_pd(targets_distance);
+	int vector_end = num_vehicles & ~3;
+
+	// Pass 1: minimum tour length
+	__m256d min_v = _mm256_add_pd(_mm256_add_pd(targets_distance_v, _mm256_loadu_pd(depot_distances_1)), _mm256_loadu_pd(depot_distances_2));
+	for (int slot = 4; slot < vector_end; slot += 4) {
+		__m256d tour_lengths = _mm256_add_pd(_mm256_add_pd(targets_distance_v, _mm256_loadu_pd(depot_distances_1 + slot)),
+											 _mm256_loadu_pd(depot_distances_2 + slot));
+		min_v = _mm256_min_pd(min_v, tour_lengths);
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, min_v);
+	double min_tour_length = lanes[0];
+	for (int lane = 1; lane < 4; lane++) {
+		min_tour_length = lanes[lane] < min_tour_length ? lanes[lane] : min_tour_length;
+	}
+
+	for (int slot = vector_end; slot < num_vehicles; slot++) {
+		double tour_length = targets_distance + depot_distances_1[slot] + depot_distances_2[slot];
+		min_tour_length = tour_length < min_tour_length ? tour_length : min_tour_length;
+	}
+
+	// Pass 2: every vehicle tied at the minimum
+	const __m256d best_v = _mm256_set1_pd(min_tour_length);
+	for (int slot = 0; slot < vector_end; slot += 4) {
+		__m256d tour_lengths = _mm256_add_pd(_mm256_add_pd(targets_distance_v, _mm256_loadu_pd(depot_distances_1 + slot)),
+											 _mm256_loadu_pd(depot_distances_2 + slot));
+		int tied_lanes = _mm256_movemask_pd(_mm256_cmp_pd(tour_lengths, best_v, _CMP_EQ_OQ));
+		while (tied_lanes != 0) {
+			int lane = __builtin_ctz(tied_lanes);
+			best_vehicle_slots.push_back(slot + lane);
+			tied_lanes &= tied_lanes - 1;
+		}
+	}
+
+	for (int slot = vector_end; slot < num_vehicles; slot++) {
+		if (targets_distance + depot_distances_1[slot] + depot_distances_2[slot] == min_tour_length) {
+			best_vehicle_slots.push_back(slot);
+		}
+	}
+
+	return min_tour_length;
+}
+#endif
+
+/*
+ * Best-vehicle kernel dispatch: AVX2 when available at compile time, scalar otherwise
+ * (parameters as in best_pair_vehicles_scalar)
+ */
+double best_pair_vehicles(const double* depot_distances_1, const double* depot_distances_2, double targets_distance,
+						  int num_vehicles, std::vector<int>& best_vehicle_slots) {
+#ifdef __AVX2__
+	return best_pair_vehicles_avx2(depot_distances_1, depot_distances_2, targets_distance, num_vehicles, best_vehicle_slots);
+#else
+	return best_pair_vehicles_scalar(depot_distances_1, depot_distances_2, targets_distance, num_vehicles, best_vehicle_slots);
+#endif
+}
@@ -0,0 +1,469 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "best_vehicle_kernel.h"
+#include "distance_tables.h"
+#include "spatial_index.h"
+
+/*
+ * Parallel bid generation
+ * Bids are computed into plain buffers (no solver calls), one buffer per block of work. Blocks are handed out to a
+ * pool of worker threads and the buffers are concatenated in block order afterwards, so the merged bid list is
+ * identical to the one produced by a single thread.
+ * Columns a vehicle cannot carry are never generated: vehicles are grouped into capacity buckets ordered by
+ * descending capacity, so the vehicles able to carry a bundle of a given weight are a prefix of that order.
+ * With many depots, best bids can be selected through a spatial grid over the depots instead of scanning every vehicle;
+ * both paths produce the same bids.
+ */
+
+struct BidRecord {
+	double tour_length;
+	int vehicle_id;
+	int target_id_1;
+	int target_id_2;	// -1 for singleton bids
+};
+
+struct CapacityBuckets {
+	std::vector<int> vehicle_order;		// Vehicle IDs by descending capacity, ties by ID (the vehicle slot order of the distance tables)
+	std::vector<int> capacities;		// Distinct vehicle capacities, descending
+	std::vector<int> bucket_end;		// Vehicles able to carry capacities[b] occupy slots [0, bucket_end[b])
+};
+
+struct CandidatePairs {
+	std::vector<int> row_start;		// Partners of target t are partners[row_start[t], row_start[t + 1])
+	std::vector<int> partners;		// Second target IDs (greater than the first), ascending within each row
+};
+
+struct TiedVehicles {
+	std::vector<int> start;				// Vehicles tied for bid b are vehicle_ids[start[b], start[b + 1]) (the bid's own vehicle first)
+	std::vector<int> vehicle_ids;
+};
+
+struct PruningStats {
+	long long pairs_considered;
+	long long pairs_removed;
+	long long pair_columns_considered;
+	long long pair_columns_removed;
+};
+
+// The depot grid is used for a pair when it is expected to visit fewer than 1 / BID_GRID_PAIR_SCAN_RATIO of the
+// vehicles a full scan would read (a grid visit costs several kernel lanes)
+const int BID_GRID_PAIR_SCAN_RATIO = 8;
+
+// Number of blocks handed out per worker thread (more blocks balance the shrinking rows of the pair triangle)
+const int BID_BLOCKS_PER_THREAD = 8;
+
+/*
+ * Return number of worker threads to use
+ * @param requested_threads - Requested number of threads (0 = one per hardware thread)
+ */
+int bid_generation_thread_count(int requested_threads) {
+	if (requested_threads > 0) {
+		return requested_threads;
+	}
+
+	int hardware_threads = std::thread::hardware_concurrency();
+	return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+/*
+ * Group vehicles into capacity buckets
+ * @param vehicle_capacities - Vehicle capacities (indexed by vehicle ID)
+ * @param buckets - Output: capacity buckets
+ */
+void build_capacity_buckets(const std::vector<int>& vehicle_capacities, CapacityBuckets& buckets) {
+	int num_vehicles = vehicle_capacities.size();
+	buckets.vehicle_order.resize(num_vehicles);
+	for (int vehicle_id = 0; vehicle_id < num_vehicles; vehicle_id++) {
+		buckets.vehicle_order[vehicle_id] = vehicle_id;
+	}
+
+	std::stable_sort(buckets.vehicle_order.begin(), buckets.vehicle_order.end(), [&](int vehicle_id_1, int vehicle_id_2) {
+		return vehicle_capacities[vehicle_id_1] > vehicle_capacities[vehicle_id_2];
+	});
+
+	buckets.capacities.clear();
+	buckets.bucket_end.clear();
+	for (int slot = 0; slot < num_vehicles; slot++) {
+		int capacity = vehicle_capacities[buckets.vehicle_order[slot]];
+		if (buckets.capacities.empty() || buckets.capacities.back() != capacity) {
+			buckets.capacities.push_back(capacity);
+			buckets.bucket_end.push_back(slot);
+		}
+		buckets.bucket_end.back() = slot + 1;
+	}
+}
+
+/*
+ * Return number of vehicles able to carry a given weight (they occupy slots [0, count))
+ * @param buckets - Capacity buckets
+ * @param weight - Bundle weight
+ */
+int feasible_vehicle_count(const CapacityBuckets& buckets, int weight) {
+	// Last bucket whose capacity is at least the weight (capacities are descending)
+	int low = 0;
+	int high = buckets.capacities.size();
+	while (low < high) {
+		int middle = (low + high) / 2;
+		if (buckets.capacities[middle] >= weight) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low == 0 ? 0 : buckets.bucket_end[low - 1];
+}
+
+/*
+ * Fill one buffer per block on a pool of worker threads and merge the buffers in block order
+ * @param num_blocks - Number of blocks of work
+ * @param num_threads - Number of worker threads
+ * @param fill_block - Function filling the bid buffer of a given block
+ * @param bids - Output: merged bids of all blocks, appended in block order
+ */
+void run_bid_blocks(int num_blocks, int num_threads, const std::function<void(int, std::vector<BidRecord>&)>& fill_block, std::vector<BidRecord>& bids) {
+	std::vector<std::vector<BidRecord>> block_bids(num_blocks);
+	std::atomic<int> next_block(0);
+
+	// Workers repeatedly claim the next unprocessed block
+	auto worker = [&]() {
+		for (int block = next_block++; block < num_blocks; block = next_block++) {
+			fill_block(block, block_bids[block]);
+		}
+	};
+
+	num_threads = std::max(1, std::min(num_threads, num_blocks));
+	if (num_threads == 1) {
+		worker();
+	} else {
+		std::vector<std::thread> threads;
+		for (int i = 0; i < num_threads; i++) {
+			threads.push_back(std::thread(worker));
+		}
+
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	// Deterministic merge
+	size_t total_bids = bids.size();
+	for (const auto& buffer : block_bids) {
+		total_bids += buffer.size();
+	}
+
+	bids.reserve(total_bids);
+	for (auto& buffer : block_bids) {
+		bids.insert(bids.end(), buffer.begin(), buffer.end());
+		std::vector<BidRecord>().swap(buffer);
+	}
+}
+
+/*
+ * Create singleton bids for a range of targets (only for vehicles able to carry the target)
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param tables - Distance tables of the current instance (depot rows in vehicle slot order)
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ * @param depot_grid - Spatial grid over the depots in vehicle slot order (NULL = scan all vehicles; best bids only)
+ * @param target_begin, target_end - Range of target IDs
+ * @param bids - Output: bid buffer
+ */
+void generate_singleton_bids(bool consider_only_best_bid, const DistanceTables& tables, const std::vector<int>& target_weights,
+							 const CapacityBuckets& buckets, const SpatialGrid* depot_grid, int target_begin, int target_end,
+							 std::vector<BidRecord>& bids) {
+	std::vector<int> best_bids_slots;
+
+	for (int target_id = target_begin; target_id < target_end; target_id++) {
+		const double* depot_distances = target_depot_row(tables, target_id);
+		int num_feasible_vehicles = feasible_vehicle_count(buckets, target_weights[target_id]);
+		size_t best_bids_begin = bids.size();
+		double min_tour_length = -1;
+
+		// Best bids from the nearest feasible depots
+		if (consider_only_best_bid && depot_grid != NULL) {
+			grid_nearest_ties(*depot_grid, tables.target_locations[target_id], num_feasible_vehicles, best_bids_slots);
+			for (int slot : best_bids_slots) {
+				BidRecord bid = {2.0 * depot_distances[slot], buckets.vehicle_order[slot], target_id, -1};
+				bids.push_back(bid);
+			}
+			continue;
+		}
+
+		// Create bid for each vehicle based on tour length
+		for (int slot = 0; slot < num_feasible_vehicles; slot++) {
+			double tour_length = 2.0 * depot_distances[slot];
+			BidRecord bid = {tour_length, buckets.vehicle_order[slot], target_id, -1};
+
+			// Keep only the bids tied for the shortest tour
+			if (consider_only_best_bid) {
+				if (tour_length < min_tour_length || min_tour_length == -1) {
+					bids.resize(best_bids_begin);
+					bids.push_back(bid);
+					min_tour_length = tour_length;
+				} else if (tour_length == min_tour_length) {
+					bids.push_back(bid);
+				}
+			} else {
+				bids.push_back(bid);
+			}
+		}
+	}
+}
+
+/*
+ * Build the candidate pairs of the k-nearest-neighbour mode: {t1, t2} is a candidate if either target is among the
+ * other's k nearest targets (by distance, then target ID). Pairs are symmetric, deduplicated and sorted.
+ * @param target_locations - Target coordinates, indexed by target ID
+ * @param k - Number of neighbours per target
+ * @param candidate_pairs - Output: candidate pairs
+ */
+void build_knn_candidate_pairs(const std::vector<std::pair<int, int>>& target_locations, int k, CandidatePairs& candidate_pairs) {
+	int num_targets = target_locations.size();
+	SpatialGrid target_grid;
+	build_spatial_grid(target_grid, target_locations);
+
+	// Neighbour lists (k + 1 nearest, since a target is its own nearest point)
+	std::vector<std::pair<int, int>> pairs;
+	std::vector<int> nearest_targets;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		grid_nearest_k(target_grid, target_locations[target_id], k + 1, nearest_targets);
+		int num_neighbours = 0;
+		for (int neighbour_id : nearest_targets) {
+			if (neighbour_id != target_id && num_neighbours < k) {
+				pairs.push_back(std::make_pair(std::min(target_id, neighbour_id), std::max(target_id, neighbour_id)));
+				num_neighbours++;
+			}
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+	// Rows by first target
+	candidate_pairs.row_start.assign(num_targets + 1, 0);
+	candidate_pairs.partners.resize(pairs.size());
+	for (size_t i = 0; i < pairs.size(); i++) {
+		candidate_pairs.row_start[pairs[i].first + 1]++;
+		candidate_pairs.partners[i] = pairs[i].second;
+	}
+
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		candidate_pairs.row_start[target_id + 1] += candidate_pairs.row_start[target_id];
+	}
+}
+
+/*
+ * Create pair bids for all pairs whose first (smaller) target lies in a range (only for vehicles able to carry the pair)
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param tables - Distance tables of the current instance (depot rows in vehicle slot order)
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ * @param depot_grid - Spatial grid over the depots in vehicle slot order (NULL = scan all vehicles; best bids only)
+ * @param candidate_pairs - Pairs to consider (NULL = all pairs)
+ * @param target_begin, target_end - Range of first target IDs
+ * @param bids - Output: bid buffer
+ */
+void generate_pair_bids(bool consider_only_best_bid, const DistanceTables& tables, const std::vector<int>& target_weights,
+						const CapacityBuckets& buckets, const SpatialGrid* depot_grid, const CandidatePairs* candidate_pairs,
+						int target_begin, int target_end, std::vector<BidRecord>& bids) {
+	std::vector<int> best_bids_slots;
+
+	for (int target_id_1 = target_begin; target_id_1 < target_end; target_id_1++) {
+		const double* depot_distances_1 = target_depot_row(tables, target_id_1);
+		int partners_begin = candidate_pairs != NULL ? candidate_pairs->row_start[target_id_1] : target_id_1 + 1;
+		int partners_end = candidate_pairs != NULL ? candidate_pairs->row_start[target_id_1 + 1] : tables.num_targets;
+
+		for (int partner = partners_begin; partner < partners_end; partner++) {
+			int target_id_2 = candidate_pairs != NULL ? candidate_pairs->partners[partner] : partner;
+			int num_feasible_vehicles = feasible_vehicle_count(buckets, target_weights[target_id_1] + target_weights[target_id_2]);
+			if (num_feasible_vehicles == 0) {
+				continue;
+			}
+
+			const double* depot_distances_2 = target_depot_row(tables, target_id_2);
+			double targets_distance = target_target_distance(tables, target_id_1, target_id_2);
+
+			// Only the best bids are considered: every vehicle tied for the shortest tour
+			if (consider_only_best_bid) {
+				// The depot grid only pays off when the search ellipse around the two targets holds few depots
+				bool search_grid = depot_grid != NULL
+								   && grid_expected_points_within(*depot_grid, 0.5 * targets_distance) * BID_GRID_PAIR_SCAN_RATIO < num_feasible_vehicles;
+				double min_tour_length = search_grid
+										 ? best_pair_vehicles_grid(*depot_grid, tables.target_locations[target_id_1], tables.target_locations[target_id_2],
+																   depot_distances_1, depot_distances_2, targets_distance,
+																   num_feasible_vehicles, best_bids_slots)
+										 : best_pair_vehicles(depot_distances_1, depot_distances_2, targets_distance,
+															  num_feasible_vehicles, best_bids_slots);
+				for (int slot : best_bids_slots) {
+					BidRecord bid = {min_tour_length, buckets.vehicle_order[slot], target_id_1, target_id_2};
+					bids.push_back(bid);
+				}
+			}
+
+			// Create bid for each vehicle based on tour length
+			else {
+				for (int slot = 0; slot < num_feasible_vehicles; slot++) {
+					double tour_length = targets_distance
+										+ depot_distances_1[slot]
+										+ depot_distances_2[slot];
+					BidRecord bid = {tour_length, buckets.vehicle_order[slot], target_id_1, target_id_2};
+					bids.push_back(bid);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Split the rows of the pair triangle (or of the candidate pairs) into blocks holding roughly equal numbers of pairs
+ * @param num_targets - Number of targets
+ * @param candidate_pairs - Pairs to consider (NULL = all pairs)
+ * @param num_blocks - Desired number of blocks
+ * Return block boundaries (first target IDs), starting at 0 and ending at num_targets
+ */
+std::vector<int> pair_block_boundaries(int num_targets, const CandidatePairs* candidate_pairs, int num_blocks) {
+	std::vector<int> boundaries(1, 0);
+	long long total_pairs = candidate_pairs != NULL ? (long long) candidate_pairs->partners.size() : (long long) num_targets * (num_targets - 1) / 2;
+	long long pairs_per_block = std::max(1LL, total_pairs / std::max(1, num_blocks));
+	long long block_pairs = 0;
+
+	for (int target_id_1 = 0; target_id_1 < num_targets; target_id_1++) {
+		block_pairs += candidate_pairs != NULL ? candidate_pairs->row_start[target_id_1 + 1] - candidate_pairs->row_start[target_id_1]
+											   : num_targets - 1 - target_id_1;
+		if (block_pairs >= pairs_per_block && target_id_1 + 1 < num_targets) {
+			boundaries.push_back(target_id_1 + 1);
+			block_pairs = 0;
+		}
+	}
+
+	boundaries.push_back(num_targets);
+	return boundaries;
+}
+
+/*
+ * Generate all singleton bids followed by all pair bids, in parallel
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param tables - Distance tables of the current instance
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ * @param depot_grid - Spatial grid over the depots in vehicle slot order (NULL = scan all vehicles; best bids only)
+ * @param candidate_pairs - Pairs to bid on (NULL = all pairs); singletons are always generated for every target
+ * @param requested_threads - Number of worker threads (0 = one per hardware thread, 1 = serial)
+ * @param bids - Output: generated bids (singletons by target, then pairs by (target_1, target_2), vehicles in slot order)
+ */
+void generate_bids(bool consider_only_best_bid, const DistanceTables& tables, const std::vector<int>& target_weights,
+				   const CapacityBuckets& buckets, const SpatialGrid* depot_grid, const CandidatePairs* candidate_pairs,
+				   int requested_threads, std::vector<BidRecord>& bids) {
+	int num_threads = bid_generation_thread_count(requested_threads);
+	int num_targets = tables.num_targets;
+	bids.clear();
+
+	// Singleton bids: fixed-size blocks of targets
+	int singleton_blocks = std::max(1, std::min(num_targets, num_threads * BID_BLOCKS_PER_THREAD));
+	run_bid_blocks(singleton_blocks, num_threads, [&](int block, std::vector<BidRecord>& block_bids) {
+		int target_begin = (long long) num_targets * block / singleton_blocks;
+		int target_end = (long long) num_targets * (block + 1) / singleton_blocks;
+		generate_singleton_bids(consider_only_best_bid, tables, target_weights, buckets, depot_grid, target_begin, target_end, block_bids);
+	}, bids);
+
+	// Pair bids: blocks of rows of the pair triangle
+	std::vector<int> boundaries = pair_block_boundaries(num_targets, candidate_pairs, num_threads * BID_BLOCKS_PER_THREAD);
+	run_bid_blocks(boundaries.size() - 1, num_threads, [&](int block, std::vector<BidRecord>& block_bids) {
+		generate_pair_bids(consider_only_best_bid, tables, target_weights, buckets, depot_grid, candidate_pairs,
+						   boundaries[block], boundaries[block + 1], block_bids);
+	}, bids);
+}
+
+/*
+ * Remove dominated pair bids in place, preserving the order of the remaining bids
+ * A pair {t1, t2} whose best tour length is at least the sum of the best singleton tour lengths of t1 and t2 can
+ * always be replaced by those two singletons at no extra cost, so it is never needed for an optimal cover
+ * (all columns of such a pair are removed, whichever vehicle they belong to).
+ * @param num_targets - Number of targets
+ * @param bids - Generated bids (the columns of each pair must be contiguous, as produced by generate_bids)
+ * @param stats - Output: pruning counts
+ */
+void prune_dominated_pair_bids(int num_targets, std::vector<BidRecord>& bids, PruningStats& stats) {
+	stats = PruningStats();
+
+	// Best singleton tour length of each target (infinite if the target has no singleton bid)
+	std::vector<double> best_singleton(num_targets, std::numeric_limits<double>::infinity());
+	for (const BidRecord& bid : bids) {
+		if (bid.target_id_2 == -1 && bid.tour_length < best_singleton[bid.target_id_1]) {
+			best_singleton[bid.target_id_1] = bid.tour_length;
+		}
+	}
+
+	size_t kept = 0;
+	size_t bid_index = 0;
+	while (bid_index < bids.size()) {
+		// Group of columns belonging to the same bundle
+		size_t group_end = bid_index + 1;
+		double best_tour_length = bids[bid_index].tour_length;
+		while (group_end < bids.size() && bids[group_end].target_id_1 == bids[bid_index].target_id_1
+				&& bids[group_end].target_id_2 == bids[bid_index].target_id_2) {
+			best_tour_length = std::min(best_tour_length, bids[group_end].tour_length);
+			group_end++;
+		}
+
+		const BidRecord& bid = bids[bid_index];
+		bool dominated = bid.target_id_2 != -1
+						 && best_tour_length >= best_singleton[bid.target_id_1] + best_singleton[bid.target_id_2];
+
+		if (bid.target_id_2 != -1) {
+			stats.pairs_considered++;
+			stats.pair_columns_considered += group_end - bid_index;
+		}
+
+		if (dominated) {
+			stats.pairs_removed++;
+			stats.pair_columns_removed += group_end - bid_index;
+		} else {
+			for (size_t i = bid_index; i < group_end; i++) {
+				bids[kept++] = bids[i];
+			}
+		}
+
+		bid_index = group_end;
+	}
+
+	bids.resize(kept);
+}
+
+/*
+ * Collapse best bids of the same bundle that are tied between several vehicles into a single bid, in place
+ * The kept bid carries the first tied vehicle (lowest vehicle slot); all tied vehicles are recorded so that a vehicle
+ * can be chosen among them after solving.
+ * @param bids - Best bids (the tied bids of each bundle must be contiguous, as produced by generate_bids)
+ * @param ties - Output: tied vehicles of each remaining bid
+ */
+void collapse_tied_bids(std::vector<BidRecord>& bids, TiedVehicles& ties) {
+	ties.start.assign(1, 0);
+	ties.vehicle_ids.clear();
+
+	size_t kept = 0;
+	size_t bid_index = 0;
+	while (bid_index < bids.size()) {
+		const BidRecord bid = bids[bid_index];
+		ties.vehicle_ids.push_back(bid.vehicle_id);
+
+		// Following bids of the same bundle at the same tour length
+		bid_index++;
+		while (bid_index < bids.size() && bids[bid_index].target_id_1 == bid.target_id_1 && bids[bid_index].target_id_2 == bid.target_id_2
+			   && bids[bid_index].tour_length == bid.tour_length) {
+			ties.vehicle_ids.push_back(bids[bid_index].vehicle_id);
+			bid_index++;
+		}
+
+		bids[kept++] = bid;
+		ties.start.push_back(ties.vehicle_ids.size());
+	}
+
+	bids.resize(kept);
+}
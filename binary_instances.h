@@ -0,0 +1,278 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dataset_parser.h"
+
+/*
+ * Binary columnar instance format (version 1, little-endian)
+ *   header:          magic "CVRPINST", uint32 version, uint32 byte order mark (0x01020304), uint64 number of data
+ *                    sets, uint64 byte offset of the index
+ *   per data set:    name bytes (padded to 4), then int32 arrays vehicle x[V], vehicle y[V], capacity[V],
+ *                    target x[T], target y[T], weight[T]
+ *   index:           per data set uint64 offset of its block, uint32 name length, uint32 V, uint32 T, uint32 reserved
+ * The file is mapped and its data sets loaded directly from the arrays. Converted text data sets store the capacity
+ * the text path assigns (DEFAULT_VEHICLE_CAPACITY), so both paths build the same instances.
+ */
+
+const char		BINARY_INSTANCES_MAGIC[8] = {'C', 'V', 'R', 'P', 'I', 'N', 'S', 'T'};
+const uint32_t	BINARY_INSTANCES_VERSION = 1;
+const uint32_t	BINARY_INSTANCES_BYTE_ORDER = 0x01020304;
+const int		DEFAULT_VEHICLE_CAPACITY = 100;		// Capacity of every vehicle of a text data set
+
+struct BinaryInstancesHeader {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byte_order;
+	uint64_t	num_datasets;
+	uint64_t	index_offset;
+};
+
+struct BinaryDatasetEntry {
+	uint64_t	offset;
+	uint32_t	name_length;
+	uint32_t	num_vehicles;
+	uint32_t	num_targets;
+	uint32_t	reserved;
+};
+
+/*
+ * Return whether mapped data starts with the binary instance magic
+ * @param data, size - Mapped data
+ */
+bool is_binary_instances(const char* data, size_t size) {
+	return size >= sizeof(BinaryInstancesHeader) && memcmp(data, BINARY_INSTANCES_MAGIC, sizeof(BINARY_INSTANCES_MAGIC)) == 0;
+}
+
+/*
+ * Return the padded byte size of a data set block
+ * @param entry - Index entry of the data set
+ */
+uint64_t binary_dataset_size(const BinaryDatasetEntry& entry) {
+	uint64_t name_size = (entry.name_length + 3) / 4 * 4;
+	return name_size + sizeof(int32_t) * (3 * (uint64_t) entry.num_vehicles + 3 * (uint64_t) entry.num_targets);
+}
+
+/*
+ * Validate the header of a mapped binary instance file and index its data sets
+ * @param file - Mapped binary instance file (index is filled; each entry's offset is that of its index entry)
+ */
+void index_binary_instances(DatasetFile& file) {
+	BinaryInstancesHeader header;
+	memcpy(&header, file.data, sizeof(header));
+	if (header.byte_order != BINARY_INSTANCES_BYTE_ORDER) {
+		throw std::runtime_error(file.file_name + ": binary instances written with a different byte order");
+	}
+	if (header.version != BINARY_INSTANCES_VERSION) {
+		throw std::runtime_error(file.file_name + ": unsupported binary instance version " + std::to_string(header.version));
+	}
+	if (header.index_offset > file.size || header.num_datasets > (file.size - header.index_offset) / sizeof(BinaryDatasetEntry)) {
+		throw std::runtime_error(file.file_name + ": truncated binary instance index");
+	}
+
+	file.binary = true;
+	file.index.clear();
+	for (uint64_t dataset = 0; dataset < header.num_datasets; dataset++) {
+		size_t entry_offset = header.index_offset + dataset * sizeof(BinaryDatasetEntry);
+		BinaryDatasetEntry entry;
+		memcpy(&entry, file.data + entry_offset, sizeof(entry));
+		if (entry.offset % 4 != 0 || entry.offset > file.size || binary_dataset_size(entry) > file.size - entry.offset) {
+			throw std::runtime_error(file.file_name + ": data set " + std::to_string(dataset + 1) + " lies outside the file");
+		}
+
+		DatasetIndexEntry index_entry = {entry_offset, (int) dataset + 1};
+		file.index.push_back(index_entry);
+	}
+}
+
+/*
+ * Map an instance file, binary or text (detected from its first bytes), and index its data sets
+ * @param file_name - Name of the instance file
+ * @param file - Output: mapped and indexed instance file
+ * Return false if the file could not be opened or mapped
+ */
+bool open_instance_file(const std::string& file_name, DatasetFile& file) {
+	file = DatasetFile();
+	file.file_name = file_name;
+	if (!map_file(file_name, file.data, file.size)) {
+		return false;
+	}
+
+	if (is_binary_instances(file.data, file.size)) {
+		index_binary_instances(file);
+	} else {
+		index_dataset_file(file);
+	}
+	return true;
+}
+
+/*
+ * Load one data set of a mapped binary instance file
+ * @param file - Mapped and indexed binary instance file
+ * @param dataset_number - Data set number (0-based)
+ * @param instance - Output: loaded instance
+ */
+void load_binary_dataset(const DatasetFile& file, int dataset_number, ParsedInstance& instance) {
+	if (dataset_number < 0 || dataset_number >= (int) file.index.size()) {
+		throw std::out_of_range(file.file_name + ": no data set number " + std::to_string(dataset_number));
+	}
+
+	BinaryDatasetEntry entry;
+	memcpy(&entry, file.data + file.index[dataset_number].offset, sizeof(entry));
+	const char* block = file.data + entry.offset;
+	instance.name.assign(block, entry.name_length);
+
+	// Columns (the block is 4-byte aligned in the page-aligned mapping)
+	const int32_t* columns = (const int32_t*) (block + (entry.name_length + 3) / 4 * 4);
+	const int32_t* vehicle_x = columns;
+	const int32_t* vehicle_y = vehicle_x + entry.num_vehicles;
+	const int32_t* capacities = vehicle_y + entry.num_vehicles;
+	const int32_t* target_x = capacities + entry.num_vehicles;
+	const int32_t* target_y = target_x + entry.num_targets;
+	const int32_t* weights = target_y + entry.num_targets;
+
+	instance.vehicle_locations.resize(entry.num_vehicles);
+	for (uint32_t i = 0; i < entry.num_vehicles; i++) {
+		instance.vehicle_locations[i] = std::make_pair(vehicle_x[i], vehicle_y[i]);
+	}
+	instance.capacities.assign(capacities, capacities + entry.num_vehicles);
+
+	instance.target_locations.resize(entry.num_targets);
+	for (uint32_t i = 0; i < entry.num_targets; i++) {
+		instance.target_locations[i] = std::make_pair(target_x[i], target_y[i]);
+	}
+	instance.weights.assign(weights, weights + entry.num_targets);
+}
+
+/*
+ * Load one data set of a mapped instance file, binary or text
+ * @param file - Mapped and indexed instance file
+ * @param dataset_number - Data set number (0-based)
+ * @param instance - Output: loaded instance
+ */
+void load_dataset(const DatasetFile& file, int dataset_number, ParsedInstance& instance) {
+	if (file.binary) {
+		load_binary_dataset(file, dataset_number, instance);
+	} else {
+		parse_dataset(file, dataset_number, instance);
+	}
+}
+
+/*
+ * Write instances in the binary format
+ * @param instances - Instances to write (instances without capacities get DEFAULT_VEHICLE_CAPACITY)
+ * @param file_name - Name of the binary file
+ * Return false if the file could not be written
+ */
+bool write_binary_instances(const std::vector<ParsedInstance>& instances, const std::string& file_name) {
+	std::ofstream outfile(file_name, std::ios_base::binary | std::ios_base::trunc);
+	if (!outfile.is_open()) {
+		return false;
+	}
+
+	BinaryInstancesHeader header = {};
+	memcpy(header.magic, BINARY_INSTANCES_MAGIC, sizeof(header.magic));
+	header.version = BINARY_INSTANCES_VERSION;
+	header.byte_order = BINARY_INSTANCES_BYTE_ORDER;
+	header.num_datasets = instances.size();
+	outfile.write((const char*) &header, sizeof(header));
+
+	// Data set blocks
+	std::vector<BinaryDatasetEntry> entries;
+	std::vector<int32_t> columns;
+	uint64_t offset = sizeof(header);
+	for (const ParsedInstance& instance : instances) {
+		BinaryDatasetEntry entry = {offset, (uint32_t) instance.name.size(), (uint32_t) instance.vehicle_locations.size(),
+									(uint32_t) instance.target_locations.size(), 0};
+		entries.push_back(entry);
+
+		outfile.write(instance.name.data(), instance.name.size());
+		const char padding[4] = {0, 0, 0, 0};
+		outfile.write(padding, (4 - instance.name.size() % 4) % 4);
+
+		columns.clear();
+		for (const std::pair<int, int>& location : instance.vehicle_locations) {
+			columns.push_back(location.first);
+		}
+		for (const std::pair<int, int>& location : instance.vehicle_locations) {
+			columns.push_back(location.second);
+		}
+		for (size_t i = 0; i < instance.vehicle_locations.size(); i++) {
+			columns.push_back(instance.capacities.empty() ? DEFAULT_VEHICLE_CAPACITY : instance.capacities[i]);
+		}
+		for (const std::pair<int, int>& location : instance.target_locations) {
+			columns.push_back(location.first);
+		}
+		for (const std::pair<int, int>& location : instance.target_locations) {
+			columns.push_back(location.second);
+		}
+		columns.insert(columns.end(), instance.weights.begin(), instance.weights.end());
+		outfile.write((const char*) columns.data(), columns.size() * sizeof(int32_t));
+
+		offset += binary_dataset_size(entry);
+	}
+
+	// Index, then the header with its offset
+	outfile.write((const char*) entries.data(), entries.size() * sizeof(BinaryDatasetEntry));
+	header.index_offset = offset;
+	outfile.seekp(0);
+	outfile.write((const char*) &header, sizeof(header));
+	return outfile.good();
+}
+
+/*
+ * Write instances in the dataset text format (capacities are not part of it and are dropped)
+ * @param instances - Instances to write
+ * @param file_name - Name of the text file
+ * Return false if the file could not be written
+ */
+bool write_text_instances(const std::vector<ParsedInstance>& instances, const std::string& file_name) {
+	std::ofstream outfile(file_name, std::ios_base::trunc);
+	if (!outfile.is_open()) {
+		return false;
+	}
+
+	for (const ParsedInstance& instance : instances) {
+		outfile << instance.name << "\n";
+		outfile << "Vehicle locations :";
+		for (const std::pair<int, int>& location : instance.vehicle_locations) {
+			outfile << location.first << "," << location.second << ";";
+		}
+		outfile << "\nTarget locations :";
+		for (const std::pair<int, int>& location : instance.target_locations) {
+			outfile << location.first << "," << location.second << ";";
+		}
+		outfile << "\nWeights = ";
+		for (size_t i = 0; i < instance.weights.size(); i++) {
+			outfile << (i > 0 ? "," : "") << instance.weights[i];
+		}
+		outfile << "\n";
+	}
+
+	return outfile.good();
+}
+
+/*
+ * Convert an instance file (binary or text) to the other format
+ * @param input_file_name - Name of the instance file to convert
+ * @param output_file_name - Name of the converted file
+ * Return false if the input could not be read or the output written
+ */
+bool convert_instance_file(const std::string& input_file_name, const std::string& output_file_name) {
+	DatasetFile file;
+	if (!open_instance_file(input_file_name, file)) {
+		return false;
+	}
+
+	std::vector<ParsedInstance> instances(file.index.size());
+	for (size_t dataset = 0; dataset < instances.size(); dataset++) {
+		load_dataset(file, dataset, instances[dataset]);
+	}
+	bool binary_input = file.binary;
+	close_dataset_file(file);
+
+	return binary_input ? write_text_instances(instances, output_file_name) : write_binary_instances(instances, output_file_name);
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+#include "bid_generation.h"
+#include "distance_tables.h"
+#include "spatial_index.h"
+
+/*
+ * Pricing of bundle bids for column generation
+ * Given the duals pi of the per-target cover constraints, a bundle column has reduced cost tour_length - sum(pi) over
+ * its targets. Bundles are never enumerated: with D_t the distance from target t to its nearest depot able to carry it,
+ *   pair {i, j}:       tour_length >= d(i,j) + D_i + D_j
+ *   triple {i, j, k}:  tour_length >= 2 d(i,j)   (a closed tour is at least twice the distance between any two stops)
+ * so for each target only the partners inside a radius derived from the duals can price out, and those are found with
+ * a ring search over a spatial grid of the targets.
+ */
+
+struct PricedColumn {
+	double	reduced_cost;
+	double	tour_length;
+	int		vehicle_id;
+	int		target_ids[3];		// Ascending; target_ids[2] = -1 for pairs
+};
+
+struct PricingStats {
+	long long bundles_examined;		// Bundles whose exact tour length was computed
+	long long columns_found;		// Bundles with negative reduced cost (before the per-round limit)
+};
+
+// Columns whose reduced cost is not below -PRICING_TOLERANCE are not added
+const double PRICING_TOLERANCE = 1e-6;
+
+/*
+ * Return a key identifying a bundle (target IDs ascending; -1 for unused positions)
+ * @param num_targets - Number of targets
+ * @param target_id_1, target_id_2, target_id_3 - Target IDs of the bundle
+ */
+long long bundle_key(int num_targets, int target_id_1, int target_id_2, int target_id_3) {
+	return ((long long) target_id_1 * (num_targets + 1) + (target_id_2 + 1)) * (num_targets + 1) + (target_id_3 + 1);
+}
+
+/*
+ * Return distance from each target to the nearest depot able to carry it (infinite if none can)
+ * @param tables - Distance tables of the current instance (depot rows in vehicle slot order)
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ */
+std::vector<double> nearest_feasible_depot_distances(const DistanceTables& tables, const std::vector<int>& target_weights, const CapacityBuckets& buckets) {
+	std::vector<double> depot_distances(tables.num_targets, std::numeric_limits<double>::infinity());
+	for (int target_id = 0; target_id < tables.num_targets; target_id++) {
+		const double* row = target_depot_row(tables, target_id);
+		int num_feasible_vehicles = feasible_vehicle_count(buckets, target_weights[target_id]);
+		for (int slot = 0; slot < num_feasible_vehicles; slot++) {
+			depot_distances[target_id] = std::min(depot_distances[target_id], row[slot]);
+		}
+	}
+
+	return depot_distances;
+}
+
+/*
+ * Return the shortest tour length of a triple over the vehicles able to carry it (lowest slot on ties)
+ * @param tables - Distance tables of the current instance
+ * @param target_id_1, target_id_2, target_id_3 - Target IDs
+ * @param num_vehicles - Number of vehicle slots able to carry the triple (must be positive)
+ * @param best_slot - Output: vehicle slot of the shortest tour
+ */
+double best_triple_tour(const DistanceTables& tables, int target_id_1, int target_id_2, int target_id_3, int num_vehicles, int& best_slot) {
+	const double* row_1 = target_depot_row(tables, target_id_1);
+	const double* row_2 = target_depot_row(tables, target_id_2);
+	const double* row_3 = target_depot_row(tables, target_id_3);
+	double distance_12 = target_target_distance(tables, target_id_1, target_id_2);
+	double distance_13 = target_target_distance(tables, target_id_1, target_id_3);
+	double distance_23 = target_target_distance(tables, target_id_2, target_id_3);
+	double min_tour_length = -1;
+
+	for (int slot = 0; slot < num_vehicles; slot++) {
+		// The three distinct cycles depot -> a -> b -> c -> depot (each is equal to its reverse)
+		double tour_length = std::min(std::min(row_1[slot] + distance_12 + distance_23 + row_3[slot],
+											   row_2[slot] + distance_12 + distance_13 + row_3[slot]),
+									  row_1[slot] + distance_13 + distance_23 + row_2[slot]);
+		if (tour_length < min_tour_length || min_tour_length == -1) {
+			min_tour_length = tour_length;
+			best_slot = slot;
+		}
+	}
+
+	return min_tour_length;
+}
+
+/*
+ * Find bundle columns (pairs, and triples if max_bundle_size >= 3) with negative reduced cost
+ * Each bundle is priced with its best vehicle only: other vehicles give the same cover at a higher cost.
+ * @param tables - Distance tables of the current instance (depot rows in vehicle slot order)
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ * @param target_grid - Spatial grid over the target locations (point index = target ID)
+ * @param depot_distances - Nearest feasible depot distance of each target (nearest_feasible_depot_distances)
+ * @param duals - Dual value of each target's cover constraint (indexed by target ID)
+ * @param max_bundle_size - Largest bundle to price (2 or 3)
+ * @param existing_bundles - Keys of the bundles already in the model (bundle_key)
+ * @param max_columns - Maximum number of columns to return (the most negative reduced costs are kept)
+ * @param columns - Output: priced columns, most negative reduced cost first
+ * @param stats - Output: pricing counts
+ */
+void price_bundle_columns(const DistanceTables& tables, const std::vector<int>& target_weights, const CapacityBuckets& buckets,
+						  const SpatialGrid& target_grid, const std::vector<double>& depot_distances, const std::vector<double>& duals,
+						  int max_bundle_size, const std::unordered_set<long long>& existing_bundles, int max_columns,
+						  std::vector<PricedColumn>& columns, PricingStats& stats) {
+	int num_targets = tables.num_targets;
+	columns.clear();
+	stats = PricingStats();
+
+	// a_t = pi_t - D_t: a pair {i, j} can only price out if d(i,j) < a_i + a_j
+	std::vector<double> pair_slack(num_targets);
+	double max_pair_slack = -std::numeric_limits<double>::infinity();
+	double max_dual = -std::numeric_limits<double>::infinity();
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		pair_slack[target_id] = duals[target_id] - depot_distances[target_id];
+		max_pair_slack = std::max(max_pair_slack, pair_slack[target_id]);
+		max_dual = std::max(max_dual, duals[target_id]);
+	}
+
+	std::vector<int> neighbours;
+	std::vector<int> best_vehicle_slots;
+	for (int target_id_1 = 0; target_id_1 < num_targets; target_id_1++) {
+		// Search radius covering every partner that could appear in a negative reduced cost bundle with target_id_1
+		double pair_radius = pair_slack[target_id_1] + max_pair_slack;
+		double triple_radius = max_bundle_size >= 3 ? 0.5 * (duals[target_id_1] + 2 * max_dual) : 0;
+		double radius = std::max(pair_radius, triple_radius);
+		if (!(radius > 0)) {
+			continue;
+		}
+
+		// Partners with a greater ID (each bundle is generated from its smallest target)
+		neighbours.clear();
+		std::pair<int, int> location = tables.target_locations[target_id_1];
+		search_grid_rings(target_grid, location.first, location.second, [&](double lower_bound) {
+			return lower_bound >= radius;
+		}, [&](int target_id_2) {
+			if (target_id_2 > target_id_1 && table_distance(tables, location, tables.target_locations[target_id_2]) < radius) {
+				neighbours.push_back(target_id_2);
+			}
+		});
+		std::sort(neighbours.begin(), neighbours.end());
+
+		for (size_t i = 0; i < neighbours.size(); i++) {
+			int target_id_2 = neighbours[i];
+			double distance_12 = target_target_distance(tables, target_id_1, target_id_2);
+			int pair_weight = target_weights[target_id_1] + target_weights[target_id_2];
+			int num_pair_vehicles = feasible_vehicle_count(buckets, pair_weight);
+			if (num_pair_vehicles == 0) {
+				continue;
+			}
+
+			// Pair {target_id_1, target_id_2}
+			if (distance_12 < pair_slack[target_id_1] + pair_slack[target_id_2]
+				&& existing_bundles.count(bundle_key(num_targets, target_id_1, target_id_2, -1)) == 0) {
+				double tour_length = best_pair_vehicles(target_depot_row(tables, target_id_1), target_depot_row(tables, target_id_2),
+														distance_12, num_pair_vehicles, best_vehicle_slots);
+				double reduced_cost = tour_length - duals[target_id_1] - duals[target_id_2];
+				stats.bundles_examined++;
+				if (reduced_cost < -PRICING_TOLERANCE) {
+					PricedColumn column = {reduced_cost, tour_length, buckets.vehicle_order[best_vehicle_slots[0]], {target_id_1, target_id_2, -1}};
+					columns.push_back(column);
+				}
+			}
+
+			// Triples {target_id_1, target_id_2, target_id_3}
+			if (max_bundle_size < 3 || 2 * distance_12 >= duals[target_id_1] + duals[target_id_2] + max_dual) {
+				continue;
+			}
+
+			for (size_t j = i + 1; j < neighbours.size(); j++) {
+				int target_id_3 = neighbours[j];
+				double triple_duals = duals[target_id_1] + duals[target_id_2] + duals[target_id_3];
+				if (2 * std::max(distance_12, std::max(target_target_distance(tables, target_id_1, target_id_3),
+													   target_target_distance(tables, target_id_2, target_id_3))) >= triple_duals) {
+					continue;
+				}
+
+				int num_triple_vehicles = feasible_vehicle_count(buckets, pair_weight + target_weights[target_id_3]);
+				if (num_triple_vehicles == 0 || existing_bundles.count(bundle_key(num_targets, target_id_1, target_id_2, target_id_3)) > 0) {
+					continue;
+				}
+
+				int best_slot = 0;
+				double tour_length = best_triple_tour(tables, target_id_1, target_id_2, target_id_3, num_triple_vehicles, best_slot);
+				double reduced_cost = tour_length - triple_duals;
+				stats.bundles_examined++;
+				if (reduced_cost < -PRICING_TOLERANCE) {
+					PricedColumn column = {reduced_cost, tour_length, buckets.vehicle_order[best_slot], {target_id_1, target_id_2, target_id_3}};
+					columns.push_back(column);
+				}
+			}
+		}
+	}
+
+	// Keep the most negative reduced costs (ties by bundle, for determinism)
+	stats.columns_found = columns.size();
+	auto more_negative = [](const PricedColumn& column_1, const PricedColumn& column_2) {
+		if (column_1.reduced_cost != column_2.reduced_cost) {
+			return column_1.reduced_cost < column_2.reduced_cost;
+		}
+		return std::lexicographical_compare(column_1.target_ids, column_1.target_ids + 3, column_2.target_ids, column_2.target_ids + 3);
+	};
+
+	if (columns.size() > (size_t) max_columns) {
+		std::partial_sort(columns.begin(), columns.begin() + max_columns, columns.end(), more_negative);
+		columns.resize(max_columns);
+	} else {
+		std::sort(columns.begin(), columns.end(), more_negative);
+	}
+}
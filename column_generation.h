@@ -0,0 +1,170 @@
+#pragma once
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+#include "gurobi_c++.h"
+#include "bundle_pricing.h"
+#include "model_builder.h"
+#include "solver_session.h"
+
+/*
+ * Column generation over the exact-cover model
+ * The restricted master starts from the seed columns with continuous variables. Each round solves the LP relaxation,
+ * reads the duals of the cover constraints in one bulk query and adds the bundle columns that price out. When no
+ * column prices out the LP relaxation is optimal over all bundles up to max_bundle_size; the generated columns are
+ * then made binary and a final MIP is solved over them (price-and-branch, so the integer solution is not guaranteed
+ * to be optimal over all bundles, but its gap to the LP bound is reported).
+ * Under a deadline every LP and the final MIP are capped at the time remaining; pricing stops when it runs out, and
+ * the LP bound is then unknown (the restricted LP is not a bound over all bundles).
+ */
+
+struct ColumnGenerationStats {
+	int			rounds;
+	int			seed_columns;
+	int			generated_columns;
+	long long	bundles_examined;
+	double		lp_bound;			// Optimal LP relaxation over all bundles (lower bound on the integer optimum; 0 if stopped at the deadline)
+	bool		stopped_at_deadline;	// Pricing stopped before the LP relaxation was optimal over all bundles
+	double		lp_seconds;
+	double		pricing_seconds;
+};
+
+/*
+ * Add priced columns to the model and to the column arrays (cover rows are not updated)
+ * @param model - GRB model
+ * @param priced_columns - Columns to add
+ * @param cover_constrs - Cover constraint of each target
+ * @param columns - Column arrays to extend
+ * @param bid_vars - Variable of each column (extended)
+ * @param existing_bundles - Keys of the bundles in the model (extended)
+ */
+void add_priced_columns(GRBModel& model, const std::vector<PricedColumn>& priced_columns, const std::vector<GRBConstr>& cover_constrs,
+						BidColumns& columns, std::vector<GRBVar>& bid_vars, std::unordered_set<long long>& existing_bundles) {
+	int num_new_columns = priced_columns.size();
+	int num_targets = cover_constrs.size();
+	std::vector<double> lower_bounds(num_new_columns, 0.0);
+	std::vector<double> upper_bounds(num_new_columns, 1.0);
+	std::vector<double> objective_coeffs(num_new_columns);
+	std::vector<char> types(num_new_columns, GRB_CONTINUOUS);
+	std::vector<GRBColumn> constr_columns(num_new_columns);
+
+	for (int i = 0; i < num_new_columns; i++) {
+		const PricedColumn& priced_column = priced_columns[i];
+		objective_coeffs[i] = priced_column.tour_length;
+		for (int target_id : priced_column.target_ids) {
+			if (target_id != -1) {
+				constr_columns[i].addTerm(1.0, cover_constrs[target_id]);
+			}
+		}
+
+		columns.tour_lengths.push_back(priced_column.tour_length);
+		columns.vehicle_ids.push_back(priced_column.vehicle_id);
+		columns.target_ids_1.push_back(priced_column.target_ids[0]);
+		columns.target_ids_2.push_back(priced_column.target_ids[1]);
+		columns.target_ids_3.push_back(priced_column.target_ids[2]);
+		existing_bundles.insert(bundle_key(num_targets, priced_column.target_ids[0], priced_column.target_ids[1], priced_column.target_ids[2]));
+	}
+
+	GRBVar* vars = model.addVars(lower_bounds.data(), upper_bounds.data(), objective_coeffs.data(), types.data(), NULL,
+								 constr_columns.data(), num_new_columns);
+	bid_vars.insert(bid_vars.end(), vars, vars + num_new_columns);
+	delete[] vars;
+}
+
+/*
+ * Run column generation on a model holding the seed columns as continuous variables, then solve the final MIP
+ * @param session - Solver session of the model (its optimize statistics count every solve)
+ * @param model - GRB model with the seed columns (continuous) and their cover constraints
+ * @param tables - Distance tables of the current instance
+ * @param target_weights - Target weights (indexed by ID)
+ * @param buckets - Vehicle capacity buckets
+ * @param max_bundle_size - Largest bundle to price (2 or 3)
+ * @param max_columns_per_round - Maximum number of columns added per round
+ * @param columns - Column arrays (extended with the generated columns; cover rows are rebuilt)
+ * @param bid_vars - Variable of each column (extended)
+ * @param cover_constrs - Cover constraint of each target
+ * @param deadline - Deadline of the solve
+ * @param stats - Output: column generation statistics
+ * Return whether the final MIP was optimized (false if the deadline passed first)
+ */
+bool run_column_generation(SolverSession& session, GRBModel& model, const DistanceTables& tables, const std::vector<int>& target_weights, const CapacityBuckets& buckets,
+						   int max_bundle_size, int max_columns_per_round, BidColumns& columns, std::vector<GRBVar>& bid_vars,
+						   const std::vector<GRBConstr>& cover_constrs, const SolveDeadline& deadline, ColumnGenerationStats& stats) {
+	int num_targets = tables.num_targets;
+	stats = ColumnGenerationStats();
+	stats.seed_columns = bid_vars.size();
+
+	// Pricing data shared by all rounds
+	SpatialGrid target_grid;
+	build_spatial_grid(target_grid, tables.target_locations);
+	std::vector<double> depot_distances = nearest_feasible_depot_distances(tables, target_weights, buckets);
+	std::unordered_set<long long> existing_bundles;
+	for (int column = 0; column < (int) columns.tour_lengths.size(); column++) {
+		existing_bundles.insert(bundle_key(num_targets, columns.target_ids_1[column], columns.target_ids_2[column], columns.target_ids_3[column]));
+	}
+
+	// Targets with a cover constraint (the others have no bid and keep a zero dual)
+	std::vector<int> covered_targets;
+	std::vector<GRBConstr> covered_constrs;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (columns.cover_row_start[target_id] != columns.cover_row_start[target_id + 1]) {
+			covered_targets.push_back(target_id);
+			covered_constrs.push_back(cover_constrs[target_id]);
+		}
+	}
+
+	std::vector<double> duals(num_targets, 0.0);
+	std::vector<PricedColumn> priced_columns;
+	PricingStats pricing_stats;
+
+	while (true) {
+		// Solve the restricted master LP (pricing stops at the deadline, or when the LP is cut short by it)
+		if (seconds_remaining(deadline) <= 0) {
+			stats.stopped_at_deadline = true;
+			break;
+		}
+		auto lp_start = std::chrono::steady_clock::now();
+		set_model_deadline(session, model, deadline);
+		optimize_in_session(session, model);
+		stats.lp_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - lp_start).count();
+		stats.rounds++;
+		if (model.get(GRB_IntAttr_Status) != GRB_OPTIMAL) {
+			stats.stopped_at_deadline = true;
+			break;
+		}
+
+		// Duals of all cover constraints in one query
+		double* constr_duals = model.get(GRB_DoubleAttr_Pi, covered_constrs.data(), covered_constrs.size());
+		for (size_t i = 0; i < covered_targets.size(); i++) {
+			duals[covered_targets[i]] = constr_duals[i];
+		}
+		delete[] constr_duals;
+
+		// Price new bundle columns
+		auto pricing_start = std::chrono::steady_clock::now();
+		price_bundle_columns(tables, target_weights, buckets, target_grid, depot_distances, duals, max_bundle_size,
+							 existing_bundles, max_columns_per_round, priced_columns, pricing_stats);
+		stats.pricing_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - pricing_start).count();
+		stats.bundles_examined += pricing_stats.bundles_examined;
+
+		if (priced_columns.empty()) {
+			break;
+		}
+
+		add_priced_columns(model, priced_columns, cover_constrs, columns, bid_vars, existing_bundles);
+		stats.generated_columns += priced_columns.size();
+	}
+
+	stats.lp_bound = stats.stopped_at_deadline ? 0 : model.get(GRB_DoubleAttr_ObjVal);
+	build_cover_rows(columns, num_targets);
+
+	// Final MIP over the generated columns
+	std::vector<char> binary_types(bid_vars.size(), GRB_BINARY);
+	model.set(GRB_CharAttr_VType, bid_vars.data(), binary_types.data(), bid_vars.size());
+	if (seconds_remaining(deadline) <= 0) {
+		return false;
+	}
+	set_model_deadline(session, model, deadline);
+	optimize_in_session(session, model);
+	return true;
+}
@@ -0,0 +1,30 @@
+#include <cstdio>
+#include <stdexcept>
+#include "binary_instances.h"
+
+/*
+ * Run Commands:
+ * g++ -std=c++17 -O2 convert_instances.cpp -o convert_instances
+ * ./convert_instances input_file output_file
+ *
+ * Convert a CVRP instance file between the dataset text format and the binary columnar format (the direction follows
+ * from the input file, e.g. CVRP_commondatasets.txt -> CVRP_commondatasets.bin and back).
+ */
+
+int main(int argc, char *argv[]) {
+	// Check command line arguments
+	if (argc != 3) {
+		fprintf(stderr, "Usage: ./convert_instances [input_file] [output_file]\n");
+		return 1;
+	}
+
+	try {
+		if (!convert_instance_file(argv[1], argv[2])) {
+			fprintf(stderr, "Could not convert %s to %s\n", argv[1], argv[2]);
+			return 1;
+		}
+	} catch (const std::exception& e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+}
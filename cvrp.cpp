@@ -1,8 +1,11 @@
 #include "cvrp.h"
+#include "decomposition.h"
+#include "live_instance.h"
+#include "streaming.h"
 
 /*
  * Run Commands:
- * g++ -std=c++11 -m64 -g cvrp.cpp -o cvrp -Iinclude/ -Llib -lgurobi_c++ -lgurobi95 -lm
+ * g++ -std=c++17 -m64 -g -O2 -march=native -pthread cvrp.cpp -o cvrp -Iinclude/ -Llib -lgurobi_c++ -lgurobi95 -lm
  * ./cvrp grid_size_x grid_size_y num_targets num_vehicles consider_only_best_bid
  */
 
@@ -23,13 +26,35 @@ int main(int argc, char *argv[]) {
     bool consider_only_best_bid = atoi(argv[5]);
 
     // Generate a problem instance with random locations and capacities
-    generate_random_instance(grid_size_x, grid_size_y, num_targets, num_vehicles);
+    generate_random_instance(cvrp_solver, grid_size_x, grid_size_y, num_targets, num_vehicles);
 
     // Create CVRP and find solution
-    cvrp(consider_only_best_bid, "results.txt");
+    cvrp(cvrp_solver, consider_only_best_bid, "results.txt");
     */
 
-    // Read dataset, solve each cvrp, and output results to output file
-    dataset_cvrp(true, "CVRP_commondatasets.txt", "best_bid_results.txt");   // Considering only best bids
-    dataset_cvrp(false, "CVRP_commondatasets.txt", "all_bids_results.txt");   // Considering all bids
+    // Read dataset once, solve each cvrp with both formulations, and output results to their output files
+    std::vector<CvrpFormulation> formulations;
+    formulations.push_back(CvrpFormulation{true, "best_bid_results.txt"});    // Considering only best bids
+    formulations.push_back(CvrpFormulation{false, "all_bids_results.txt"});   // Considering all bids
+    dataset_cvrp(formulations, "CVRP_commondatasets.txt");
+
+    // Objective degradation of the k-nearest-neighbour pair mode (for instances too large to bid on every pair)
+    // knn_degradation_report(true, 5, "CVRP_commondatasets.txt", "knn_degradation_report.txt");
+
+    // Latency of incremental live-instance updates (target added/removed/reweighted, vehicle moved/disabled) against full rebuilds
+    // live_update_report(20, "CVRP_commondatasets.txt", "live_update_report.txt");
+
+    // Rolling-horizon dispatch from a target arrival stream ("-" reads stdin): 5-unit epochs, tours committed after a 15-unit wait
+    // StreamOptions stream_options;
+    // stream_options.epoch_length = 5;
+    // stream_options.commit_wait = 15;
+    // stream_options.output_file_name = "stream_results.txt";
+    // stream_cvrp("events.txt", stream_options);
+
+    // Very large instances: spatial decomposition into regions of at most 300 targets, repaired along the split lines
+    // generate_random_instance(cvrp_solver, 5000, 5000, 100000, 4000);
+    // decomposed_cvrp(cvrp_solver, "decomposed_results.jsonl", RESULT_ENCODING_JSON_LINES);
+
+    // Release the Gurobi environment of the sequential solver
+    close_solver_session(cvrp_solver.session);
 }
\ No newline at end of file
@@ -1,25 +1,37 @@
 #pragma once
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdarg>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <regex>
 #include <stdio.h>
 #include <string>
 #include <string.h>
-#include <unordered_map>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include "gurobi_c++.h"
-
-struct Target {
-	std::pair<int, int> location;
-	int weight;
-	int id;
-};
-
-struct Vehicle {
-	std::pair<int, int> depot_location;
-	int capacity;
-	int id;
+#include "bid_generation.h"
+#include "binary_instances.h"
+#include "column_generation.h"
+#include "distance_tables.h"
+#include "instance.h"
+#include "matching_backend.h"
+#include "mip_start.h"
+#include "model_builder.h"
+#include "result_sink.h"
+#include "solver_session.h"
+
+enum SolverBackend {
+	SOLVER_BACKEND_MIP,			// Gurobi MIP over the bid columns
+	SOLVER_BACKEND_MATCHING,	// Built-in maximum-weight matching (singleton and pair bids only; Gurobi is not used)
+	SOLVER_BACKEND_CROSS_CHECK	// Both, reporting whether their objectives agree (results come from the MIP)
 };
 
 // Parameters for random capacity/weight generation
@@ -28,507 +40,663 @@ const int MAX_CAPACITY = 500;
 const int MIN_WEIGHT = 10;
 const int MAX_WEIGHT = 100;
 
-// General use fields
-std::unordered_map<int, Target>					targets;
-std::unordered_map<int, Vehicle>				vehicles;
-std::vector<int>								target_ids;
-std::vector<int>								vehicle_ids;
-std::unordered_map<int, std::vector<GRBVar>>	bids_for_target;	// Stores bid variables for each target (both singleton and pair bids)
-std::unordered_map<int, std::vector<GRBVar>>	vehicle_bids;		// Stores bid variables for each vehicle (both singleton and pair bids)
+/*
+ * Self-contained CVRP solver state: one instance (dense arrays), its precomputation, bid columns, model handles and Gurobi session
+ * Solvers share nothing but the read-only configuration below, so several can solve different instances concurrently
+ * (each owns its Gurobi environment, which must not be shared between threads).
+ */
+struct CvrpSolver {
+	Instance									instance;			// Target and vehicle arrays indexed by ID
+	BidColumns									bid_columns;		// Flat bid columns and per-target cover rows (both singleton and pair bids)
+	std::vector<GRBVar>							bid_vars;			// Stores bid variable of each column
+	TiedVehicles								bid_ties;			// Vehicles tied for each bid column (when the formulation is collapsed)
+	std::vector<GRBConstr>						cover_constrs;		// Cover constraint of each target (indexed by target ID)
+	DistanceTables								distance_tables;	// Target-target and target-depot distances of the current instance
+	DistanceOracle								distance_oracle;	// Offset distance table of the grid (kept across instances)
+	CapacityBuckets								capacity_buckets;	// Vehicles grouped by descending capacity (vehicle slot order of distance_tables)
+	SpatialGrid									depot_grid;			// Spatial grid over the depots (vehicle slot order), built when there are many vehicles
+	bool										use_depot_grid = false;
+	CandidatePairs								candidate_pairs;	// Candidate pairs of the k-nearest-neighbour mode
+	SolverSession								session;			// Gurobi environment shared by all instances of this solver
+	SolveDeadline								batch_deadline;		// End of the batch time budget (set by dataset_cvrp)
+	SolveDeadline								deadline;			// End of the current instance's time budget
+	int											deadline_stops = 0;	// Instances whose solve was stopped by a deadline
+	int											bid_generation_threads = -1;	// Overrides the global setting when >= 0 (batch workers use 1)
+	bool										buffer_log = false;	// Collect progress output in log instead of printing it
+	std::string									log;
+};
+
+struct CvrpFormulation {
+	bool		consider_only_best_bid;		// Only the best bid for each itemset, or all of them
+	std::string	output_file_name;			// Results file of this formulation (empty for none)
+	ResultEncoding	encoding = RESULT_ENCODING_TEXT;	// Encoding of the results file
+};
+
+// Configuration (shared read-only by all solvers)
+int												depot_grid_min_vehicles = 64;	// Best bids use the depot grid from this many vehicles on (0 = never)
+int												bid_generation_threads = 0;	// Worker threads for bid generation (0 = one per hardware thread)
+int												pair_neighbours_k = 0;		// Heuristic mode: only bid on pairs among each target's k nearest neighbours (0 = all pairs)
+SolverBackend									solver_backend = SOLVER_BACKEND_MIP;	// Column generation always uses the MIP
+bool											use_column_generation = false;	// Price bundle bids lazily from the LP duals instead of enumerating all pairs
+int												max_bundle_size = 2;			// Largest bundle priced by column generation (2 or 3)
+int												column_generation_seed_k = 2;	// Column generation seed: pairs among each target's k nearest neighbours
+int												column_generation_max_columns = 0;	// Columns added per pricing round (0 = number of targets)
+bool											use_greedy_mip_start = true;	// Start the MIP from the greedy savings cover
+bool											collapse_formulations = true;	// Solve all-bids as best-bid (ties collapsed) when no per-vehicle constraint couples the bids
+bool											prune_dominated_pairs = true;	// Drop pair bids dominated by their two singletons before building the model
+bool											name_bid_variables = false;	// Name bid variables "vehicle,target_1[,target_2]" (for model debugging only)
+int												batch_threads = 0;	// Instances solved concurrently by dataset_cvrp (0 = one per hardware thread)
+double											instance_time_limit = 0;	// Seconds per instance, bid generation included (0 = no limit)
+double											batch_time_limit = 0;	// Seconds per dataset_cvrp batch (0 = no limit)
+bool											quiet_results = false;	// Skip printing each solution (results files are still written)
+
+// Solver of the sequential entry points (batch workers copy its Gurobi parameters)
+CvrpSolver										cvrp_solver;
 
 // General use functions
-double euclidean_distance(std::pair<int, int> location1, std::pair<int, int> location2);
-void generate_random_instance(int grid_size_x, int grid_size_y, int num_targets, int num_vehicles);
-void create_singleton_bids(bool consider_only_best_bid, GRBModel& model, GRBLinExpr* objFunction);
-void create_pair_bids(bool consider_only_best_bid, GRBModel& model, GRBLinExpr* objFunction);
-void create_constraints(GRBModel& model);
-void append_results_to_file(std::string output_file_name, GRBModel& model, std::string instance_name);
-void print_results(GRBModel& model, std::string instance_name);
-void cvrp(bool consider_only_best_bid, std::string output_file_name, std::string instance_name = "CVRP Instance");
+void solver_log(CvrpSolver& solver, const char* format, ...);
+void generate_random_instance(CvrpSolver& solver, int grid_size_x, int grid_size_y, int num_targets, int num_vehicles);
+void build_instance_tables(CvrpSolver& solver);
+bool has_vehicle_coupling_constraints();
+bool generates_best_bids_only(bool consider_only_best_bid);
+void create_bids(CvrpSolver& solver, bool consider_only_best_bid);
+void create_bid_variables(CvrpSolver& solver, GRBModel& model);
+void create_constraints(CvrpSolver& solver, GRBModel& model);
+void build_result_record(CvrpSolver& solver, const CvrpSolution& solution, std::string instance_name, double solve_seconds, ResultRecord& record);
+void append_results_to_file(std::string output_file_name, ResultEncoding encoding, const std::string& results);
+void print_results(CvrpSolver& solver, const CvrpSolution& solution, std::string instance_name);
+void solve_bid_columns(CvrpSolver& solver, std::chrono::steady_clock::time_point build_start, CvrpSolution& solution);
+void solve_formulation(CvrpSolver& solver, bool consider_only_best_bid, CvrpSolution& solution);
+void start_instance_solve(CvrpSolver& solver);
+void solve_instance(CvrpSolver& solver, bool consider_only_best_bid, CvrpSolution& solution);
+std::vector<double> cvrp_formulations(CvrpSolver& solver, const std::vector<CvrpFormulation>& formulations, std::string instance_name,
+									 std::vector<std::string>* encoded_results = NULL);
+double cvrp(CvrpSolver& solver, bool consider_only_best_bid, std::string output_file_name, std::string instance_name = "CVRP Instance",
+			std::string* results_text = NULL);
 
 // Dataset testing functions
-void reset_state();
-void generate_instance(std::string vehicle_locations_line, std::string target_locations_line, std::string weights_line);
+void reset_state(CvrpSolver& solver);
+void generate_instance(CvrpSolver& solver, const ParsedInstance& instance);
+bool load_dataset_instance(CvrpSolver& solver, const DatasetFile& file, int dataset_number, std::string& dataset_name);
+void for_each_dataset_instance(CvrpSolver& solver, std::string input_file_name, const std::function<void(std::string)>& solve_instance);
+void dataset_cvrp(const std::vector<CvrpFormulation>& formulations, std::string input_file_name);
 void dataset_cvrp(bool consider_only_best_bid, std::string input_file_name, std::string output_file_name);
+void knn_degradation_report(bool consider_only_best_bid, int k, std::string input_file_name, std::string report_file_name);
 
 /*
- * Return Euclidean distance between two points
- * @param location1, location2 - The coordinate pairs to measure the distance between
+ * Print progress output of a solver, or collect it in the solver's log when it is buffered
+ * @param solver - CVRP solver
+ * @param format - printf format string
  */
-double euclidean_distance(std::pair<int, int> location1, std::pair<int, int> location2) {
-	int x_dist = location1.first - location2.first;
-	int y_dist = location1.second - location2.second;
-	return sqrt(x_dist * x_dist + y_dist * y_dist);
+void solver_log(CvrpSolver& solver, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	if (!solver.buffer_log) {
+		vprintf(format, args);
+	} else {
+		va_list size_args;
+		va_copy(size_args, args);
+		int length = vsnprintf(NULL, 0, format, size_args);
+		va_end(size_args);
+
+		size_t log_size = solver.log.size();
+		solver.log.resize(log_size + length + 1);
+		vsnprintf(&solver.log[log_size], length + 1, format, args);
+		solver.log.resize(log_size + length);
+	}
+	va_end(args);
 }
 
 /*
  * Generate problem instance with randomized locations and capacities
+ * @param solver - CVRP solver to generate the instance into
  * @param grid_size_x, grid_size_y - The desired grid dimensions
  * @param num_vehicles, num_targets - The desired numbers of vehicles/depots and targets
  */
-void generate_random_instance(int grid_size_x, int grid_size_y, int num_targets, int num_vehicles) {
+void generate_random_instance(CvrpSolver& solver, int grid_size_x, int grid_size_y, int num_targets, int num_vehicles) {
+	reserve_instance(solver.instance, num_targets, num_vehicles);
+
 	// Generate targets
 	for (int i = 0; i < num_targets; i++) {
-		Target new_target = {};
 		int x_coor = rand() % (grid_size_x + 1);
 		int y_coor = rand() % (grid_size_y + 1);
-		new_target.location = std::make_pair(x_coor, y_coor);
-		new_target.weight = rand() % (MAX_WEIGHT - MIN_WEIGHT + 1) + MIN_WEIGHT;
-		new_target.id = i;
-		targets.insert(std::make_pair(new_target.id, new_target));
-		target_ids.push_back(new_target.id);
+		int weight = rand() % (MAX_WEIGHT - MIN_WEIGHT + 1) + MIN_WEIGHT;
+		add_target(solver.instance, std::make_pair(x_coor, y_coor), weight);
 	}
 
 	// Generate vehicles
 	for (int i = 0; i < num_vehicles; i++) {
-		Vehicle new_vehicle = {};
 		int x_coor = rand() % (grid_size_x + 1);
 		int y_coor = rand() % (grid_size_y + 1);
-		new_vehicle.depot_location = std::make_pair(x_coor, y_coor);
-		new_vehicle.capacity = rand() % (MAX_CAPACITY - MIN_CAPACITY + 1) + MIN_CAPACITY;
-		new_vehicle.id = i;
-		vehicles.insert(std::make_pair(new_vehicle.id, new_vehicle));
-		vehicle_ids.push_back(new_vehicle.id);
+		int capacity = rand() % (MAX_CAPACITY - MIN_CAPACITY + 1) + MIN_CAPACITY;
+		add_vehicle(solver.instance, std::make_pair(x_coor, y_coor), capacity);
 	}
 }
 
 /*
- * Create singleton bids
- * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
- * @param model - GRB model
- * @param objFunction - Objective function to minimize
+ * Build the distance tables (read from the distance oracle when the grid is small enough), capacity buckets, depot grid
+ * and candidate pairs of the current instance
+ * (target and vehicle IDs are dense; the depot rows of the distance tables follow the capacity bucket order; in
+ * k-nearest-neighbour and column generation modes the O(T^2) target-target table is skipped)
+ * @param solver - CVRP solver holding the instance
  */
-void create_singleton_bids(bool consider_only_best_bid, GRBModel& model, GRBLinExpr* objFunction) {
-	for (const auto& target_entry : targets) {
-		Target target = target_entry.second;
-
-		// All singleton bids for the current target
-		std::vector<GRBVar> target_singletons;
-
-		// Store best bids (in case they should be the only bids considered)
-		std::vector<std::string> best_bids_var_names;
-		std::vector<int> best_bids_vehicle_ids;
-		double min_tour_length = -1;
-
-		// Create bid for each vehicle based on tour length
-		for (const auto& vehicle_entry : vehicles) {
-			Vehicle vehicle = vehicle_entry.second;
-			std::string var_name = std::to_string(vehicle.id) + "," + std::to_string(target.id);
-			double tour_length = 2.0 * euclidean_distance(target.location, vehicle.depot_location);
-
-			// If the target's weight exceeds the vehicle's capacity, set tour length to large value
-			if (target.weight > vehicle.capacity) {
-				tour_length = std::numeric_limits<float>::max();
-			}
+void build_instance_tables(CvrpSolver& solver) {
+	const Instance& instance = solver.instance;
+	std::vector<std::pair<int, int>> target_locations;
+	gather_target_locations(instance, target_locations);
 
-			// Update best bid if applicable
-			if (consider_only_best_bid) {
-				// New best bid
-				if (tour_length < min_tour_length || min_tour_length == -1) {
-					best_bids_var_names.clear();
-					best_bids_vehicle_ids.clear();
-					best_bids_var_names.push_back(var_name);
-					best_bids_vehicle_ids.push_back(vehicle.id);
-					min_tour_length = tour_length;
-				}
+	// Order depots by vehicle slot so feasible vehicles form a prefix of each distance row
+	build_capacity_buckets(instance.vehicle_capacity, solver.capacity_buckets);
+	std::vector<std::pair<int, int>> slot_depot_locations(vehicle_count(instance));
+	for (int slot = 0; slot < vehicle_count(instance); slot++) {
+		slot_depot_locations[slot] = vehicle_location(instance, solver.capacity_buckets.vehicle_order[slot]);
+	}
 
-				// Tie for best bid
-				else if (tour_length == min_tour_length) {
-					best_bids_var_names.push_back(var_name);
-					best_bids_vehicle_ids.push_back(vehicle.id);
-				}
-			}
+	cover_locations(solver.distance_oracle, target_locations, slot_depot_locations);
+	build_distance_tables(solver.distance_tables, target_locations, slot_depot_locations, !use_column_generation && pair_neighbours_k <= 0,
+						  &solver.distance_oracle);
 
-			// Add bid to objective function
-			else {
-				GRBVar bid_var = model.addVar(0.0, 1.0, tour_length, GRB_BINARY, var_name);
-				target_singletons.push_back(bid_var);
-				GRBLinExpr* term = new GRBLinExpr(bid_var, tour_length);
-    			*objFunction += *term;
-
-    			// Account for vehicle's bid
-				if (vehicle_bids.find(vehicle.id) == vehicle_bids.end()) {
-					std::vector<GRBVar> bids;
-					bids.push_back(bid_var);
-					vehicle_bids.insert(std::make_pair(vehicle.id, bids));
-				} else {
-					vehicle_bids.find(vehicle.id) -> second.push_back(bid_var);
-				}
-			}
-		}
-
-		// If the best bids are the only ones to be considered, add them to the objective function
-		if (consider_only_best_bid) {
-	    	for (int i = 0; i < best_bids_var_names.size(); i++) {
-	    		std::string best_bid_var_name = best_bids_var_names[i];
-	    		int best_bids_vehicle_id = best_bids_vehicle_ids[i];
-
-	    		GRBVar best_bid_var = model.addVar(0.0, 1.0, min_tour_length, GRB_BINARY, best_bid_var_name);
-				target_singletons.push_back(best_bid_var);
-				GRBLinExpr* term = new GRBLinExpr(best_bid_var, min_tour_length);
-	    		*objFunction += *term;
-
-	    		// Account for vehicle's bid
-				if (vehicle_bids.find(best_bids_vehicle_id) == vehicle_bids.end()) {
-					std::vector<GRBVar> bids;
-					bids.push_back(best_bid_var);
-					vehicle_bids.insert(std::make_pair(best_bids_vehicle_id, bids));
-				} else {
-					vehicle_bids.find(best_bids_vehicle_id) -> second.push_back(best_bid_var);
-				}
-	    	}
-		}
+	// Nearest-depot index for best bid selection on large fleets
+	solver.use_depot_grid = depot_grid_min_vehicles > 0 && vehicle_count(instance) >= depot_grid_min_vehicles;
+	if (solver.use_depot_grid) {
+		build_spatial_grid(solver.depot_grid, slot_depot_locations);
+	}
 
-		// Store singleton bids for current target
-		bids_for_target.insert(std::make_pair(target.id, target_singletons));
+	// Neighbour lists of the k-nearest-neighbour pair mode (or the seed pairs of column generation)
+	if (use_column_generation) {
+		build_knn_candidate_pairs(target_locations, column_generation_seed_k, solver.candidate_pairs);
+	} else if (pair_neighbours_k > 0) {
+		build_knn_candidate_pairs(target_locations, pair_neighbours_k, solver.candidate_pairs);
 	}
 }
 
 /*
- * Create pair bids
- * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
- * @param model - GRB model
- * @param objFunction - Objective function to minimize
+ * Return whether the model has constraints coupling the bids of a vehicle (e.g. a limit on a vehicle's tours or total
+ * route length). The exact-cover model has none: each target is covered once and vehicles are independent, so a
+ * bundle is never served better by a vehicle other than its cheapest one.
  */
-void create_pair_bids(bool consider_only_best_bid, GRBModel& model, GRBLinExpr* objFunction) {
-	for (int target_id_index_1 = 0; target_id_index_1 < targets.size() - 1; target_id_index_1++) {
-		for (int target_id_index_2 = target_id_index_1 + 1; target_id_index_2 < targets.size(); target_id_index_2++) {
-			int target_id_1 = target_id_index_1;
-			int target_id_2 = target_id_index_2;
-			Target target_1 = targets[target_id_1];
-			Target target_2 = targets[target_id_2];
-
-			// All bids for the current pair of targets
-			std::vector<GRBVar> target_pair_bids;
-
-			// Store best bids (in case they should be the only bids considered)
-			std::vector<std::string> best_bids_var_names;
-			std::vector<int> best_bids_vehicle_ids;
-			double min_tour_length = -1;
-
-			// Create bid for each vehicle based on tour length
-			for (const auto& vehicle_entry : vehicles) {
-				Vehicle vehicle = vehicle_entry.second;
-				std::string var_name = std::to_string(vehicle.id) + "," + std::to_string(target_1.id) + "," + std::to_string(target_2.id);
-				double tour_length = euclidean_distance(target_1.location, target_2.location)
-									+ euclidean_distance(target_1.location, vehicle.depot_location)
-									+ euclidean_distance(target_2.location, vehicle.depot_location);
-
-				// If the target's weight exceeds the vehicle's capacity, set tour length to large value
-				if (target_1.weight + target_2.weight > vehicle.capacity) {
-					tour_length = std::numeric_limits<float>::max();
-				}
+bool has_vehicle_coupling_constraints() {
+	return false;
+}
 
-				// Update best bid if applicable
-				if (consider_only_best_bid) {
-					// New best bid
-					if (tour_length < min_tour_length || min_tour_length == -1) {
-						best_bids_var_names.clear();
-						best_bids_vehicle_ids.clear();
-						best_bids_var_names.push_back(var_name);
-						best_bids_vehicle_ids.push_back(vehicle.id);
-						min_tour_length = tour_length;
-					}
-
-					// Tie for best bid
-					else if (tour_length == min_tour_length) {
-						best_bids_var_names.push_back(var_name);
-						best_bids_vehicle_ids.push_back(vehicle.id);
-					}
-				}
+/*
+ * Return whether a formulation generates only the best bid of each bundle (true for all-bids too when the formulations
+ * collapse)
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ */
+bool generates_best_bids_only(bool consider_only_best_bid) {
+	return consider_only_best_bid || (collapse_formulations && !has_vehicle_coupling_constraints());
+}
 
-				// Add bid to objective function
-				else {
-					GRBVar bid_var = model.addVar(0.0, 1.0, tour_length, GRB_BINARY, var_name);
-					target_pair_bids.push_back(bid_var);
-					GRBLinExpr* term = new GRBLinExpr(bid_var, tour_length);
-	    			*objFunction += *term;
-
-	    			// Account for vehicle's bid
-					if (vehicle_bids.find(vehicle.id) == vehicle_bids.end()) {
-						std::vector<GRBVar> bids;
-						bids.push_back(bid_var);
-						vehicle_bids.insert(std::make_pair(vehicle.id, bids));
-					} else {
-						vehicle_bids.find(vehicle.id) -> second.push_back(bid_var);
-					}
-				}
-			}
+/*
+ * Create singleton and pair bids (computed in parallel) as flat bid columns
+ * In column generation mode these are the seed columns. Without vehicle coupling constraints the all-bids formulation
+ * has the same optimum as the best-bid one, so both are collapsed to one column per bundle (its cheapest vehicle),
+ * with tied vehicles kept aside for post-processing.
+ * @param solver - CVRP solver holding the instance
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ */
+void create_bids(CvrpSolver& solver, bool consider_only_best_bid) {
+	std::vector<BidRecord> bids;
+	bool best_bids_only = generates_best_bids_only(consider_only_best_bid);
+	if (best_bids_only && !consider_only_best_bid) {
+		solver_log(solver, "Formulation collapse: all-bids solved as best-bid (no vehicle coupling constraints)\n");
+	}
 
-			// If the best bids are the only ones to be considered, add them to the objective function
-			if (consider_only_best_bid) {
-				for (int i = 0; i < best_bids_var_names.size(); i++) {
-		    		std::string best_bid_var_name = best_bids_var_names[i];
-		    		int best_bids_vehicle_id = best_bids_vehicle_ids[i];
-		    		
-		    		GRBVar best_bid_var = model.addVar(0.0, 1.0, min_tour_length, GRB_BINARY, best_bid_var_name);
-					target_pair_bids.push_back(best_bid_var);
-					GRBLinExpr* term = new GRBLinExpr(best_bid_var, min_tour_length);
-		    		*objFunction += *term;
-
-		    		// Account for vehicle's bid
-					if (vehicle_bids.find(best_bids_vehicle_id) == vehicle_bids.end()) {
-						std::vector<GRBVar> bids;
-						bids.push_back(best_bid_var);
-						vehicle_bids.insert(std::make_pair(best_bids_vehicle_id, bids));
-					} else {
-						vehicle_bids.find(best_bids_vehicle_id) -> second.push_back(best_bid_var);
-					}
-		    	}
-			}
+	generate_bids(best_bids_only, solver.distance_tables, solver.instance.target_weight, solver.capacity_buckets, solver.use_depot_grid ? &solver.depot_grid : NULL,
+				  use_column_generation || pair_neighbours_k > 0 ? &solver.candidate_pairs : NULL,
+				  solver.bid_generation_threads >= 0 ? solver.bid_generation_threads : bid_generation_threads, bids);
+
+	// Drop dominated pair bids (exact: the optimal objective is unchanged)
+	if (prune_dominated_pairs) {
+		PruningStats pruning_stats;
+		prune_dominated_pair_bids(target_count(solver.instance), bids, pruning_stats);
+		solver_log(solver, "Dominance pruning: removed %lld of %lld pair bids (%lld of %lld target pairs)\n",
+			   pruning_stats.pair_columns_removed, pruning_stats.pair_columns_considered,
+			   pruning_stats.pairs_removed, pruning_stats.pairs_considered);
+	}
 
-			// Store pair bids for current targets
-			std::vector<GRBVar>& target_1_bids = bids_for_target[target_1.id];
-			target_1_bids.insert(target_1_bids.end(), target_pair_bids.begin(), target_pair_bids.end());
-			std::vector<GRBVar>& target_2_bids = bids_for_target[target_2.id];
-			target_2_bids.insert(target_2_bids.end(), target_pair_bids.begin(), target_pair_bids.end());
-		}
+	// One column per bundle; tied vehicles are chosen among after solving
+	solver.bid_ties = TiedVehicles();
+	if (best_bids_only) {
+		collapse_tied_bids(bids, solver.bid_ties);
 	}
+
+	collect_bid_columns(bids, target_count(solver.instance), solver.bid_columns);
+	std::vector<BidRecord>().swap(bids);
+}
+
+/*
+ * Add a variable per bid column with its objective coefficient, in bulk (goal is to minimize)
+ * In column generation mode the variables are continuous (LP relaxation of the restricted master).
+ * @param solver - CVRP solver holding the bid columns
+ * @param model - GRB model
+ */
+void create_bid_variables(CvrpSolver& solver, GRBModel& model) {
+	add_bid_variables(model, solver.bid_columns, name_bid_variables, solver.bid_vars, use_column_generation ? GRB_CONTINUOUS : GRB_BINARY);
 }
 
 /*
  * Create constraints such that each target is serviced exactly once
+ * @param solver - CVRP solver holding the bid columns
  * @param model - GRB model
  */
-void create_constraints(GRBModel& model) {
-	for (auto& target_bids: bids_for_target) {
-		GRBLinExpr* target_constraint = new GRBLinExpr();
+void create_constraints(CvrpSolver& solver, GRBModel& model) {
+	add_cover_constraints(model, solver.bid_columns, solver.bid_vars, solver.cover_constrs);
+}
 
-		for (GRBVar& bid: target_bids.second) {
-			*target_constraint += *(new GRBLinExpr(bid));
+/*
+ * Describe a solution as a result record (vehicles in the order they are printed, see print_results)
+ * @param solver - CVRP solver holding the instance and bid columns
+ * @param solution - Decoded solution of the optimized model
+ * @param instance_name - Name of current problem instance
+ * @param solve_seconds - Bid generation and solve time
+ * @param record - Output: result record
+ */
+void build_result_record(CvrpSolver& solver, const CvrpSolution& solution, std::string instance_name, double solve_seconds, ResultRecord& record) {
+	record.instance_name = instance_name;
+	record.objective = solution.objective;
+	record.solve_seconds = solve_seconds;
+	record.bound = solution.bound;
+	record.stopped_at_deadline = solution.stopped_at_deadline;
+	record.uncovered_targets = solution.uncovered_targets;
+
+	gather_target_locations(solver.instance, record.target_locations);
+
+	int num_vehicles = vehicle_count(solver.instance);
+	record.vehicle_locations.resize(num_vehicles);
+	record.vehicle_order.clear();
+	record.vehicle_tours.assign(num_vehicles, std::vector<std::vector<int>>());
+	for (int vehicle_id = num_vehicles - 1; vehicle_id >= 0; vehicle_id--) {
+		record.vehicle_locations[vehicle_id] = vehicle_location(solver.instance, vehicle_id);
+		record.vehicle_order.push_back(vehicle_id);
+
+		// Bids "accepted by auctioneer"
+		for (int column : solution.vehicle_tours[vehicle_id]) {
+			int target_ids[3];
+			int num_column_targets = column_targets(solver.bid_columns, column, target_ids);
+			record.vehicle_tours[vehicle_id].push_back(std::vector<int>(target_ids, target_ids + num_column_targets));
 		}
-
-		// Constraint: target must be serviced exactly once
-		model.addConstr(*target_constraint == 1.0f, "");
 	}
 }
 
 /*
- * Output vehicle-target assignments to file
+ * Append encoded results to a results file
  * @param output_file_name - Name of file to output results to
- * @param model - Optimized Gurobi model
+ * @param encoding - Encoding of the results
+ * @param results - Encoded results
+ */
+void append_results_to_file(std::string output_file_name, ResultEncoding encoding, const std::string& results) {
+	ResultSink sink;
+	if (open_result_sink(sink, output_file_name, encoding)) {
+		write_result(sink, results);
+		close_result_sink(sink);
+	}
+}
+
+/*
+ * Print vehicle-target assignments
+ * @param solver - CVRP solver holding the instance and bid columns
+ * @param solution - Decoded solution of the optimized model
  * @param instance_name - Name of current problem instance
  */
-void append_results_to_file(std::string output_file_name, GRBModel& model, std::string instance_name) {
-	// Create output file stream
-    std::ofstream outfile;
-    outfile.open(output_file_name, std::ios_base::app); // Append to file rather than overwrite
+void print_results(CvrpSolver& solver, const CvrpSolution& solution, std::string instance_name) {
+	// Print instance name
+	solver_log(solver, "%s\n", &instance_name[0]);
 
-    if (outfile.is_open()) {
-    	// Write instance name
-    	outfile << instance_name << "\n";
+	// Print minimum sum of tour lengths
+	solver_log(solver, "Minimum Sum of Tour Lengths: %f\n", solution.objective);
+	if (solution.stopped_at_deadline) {
+		solver_log(solver, "Stopped at deadline: lower bound %f, gap %.2f%%\n", solution.bound, 100 * solution_gap(solution));
+	}
 
-		// Write minimum sum of tour lengths
-		outfile << "Minimum Sum of Tour Lengths: " << model.get(GRB_DoubleAttr_ObjVal) << "\n";
-		
-		// Track assignments of targets to vehicles
-		for (const auto& vehicle_entry : vehicles) {
-			Vehicle vehicle = vehicle_entry.second;
-
-			// Write vehicle information
-			outfile << "Vehicle: " << vehicle.depot_location.first << "," << vehicle.depot_location.second << "\n";
-
-			if (vehicle_bids.find(vehicle.id) != vehicle_bids.end()) {
-				// Track the number of tours for the current vehicle
-				int tour_count = 1;
-
-				for (auto& bid : vehicle_bids[vehicle.id]) {
-					// Bid has been "accepted by auctioneer"
-					if (bid.get(GRB_DoubleAttr_X) == 1) {
-						std::string bid_var_name = bid.get(GRB_StringAttr_VarName);
-						char* split_element = strtok(&bid_var_name[0], ",");
-						split_element = strtok(NULL, ",");
-						int target_id_1 = std::stoi(split_element);
-						Target target_1 = targets[target_id_1];
-
-						// Output tour count and first target location
-						outfile << "Tour " << tour_count++ << ": " << target_1.location.first << "," << target_1.location.second;
-
-						// If the tour encompasses two targets, output second target location
-						split_element = strtok(NULL, ",");
-						if (split_element != NULL) {
-							int target_id_2 = std::stoi(split_element);
-							Target target_2 = targets[target_id_2];
-							outfile << ";" << target_2.location.first << "," << target_2.location.second << "\n";
-						} else {
-							outfile << "\n";
-						}
-					}
-				}
-			}
+	// Print targets that could not be serviced, if any
+	const Instance& instance = solver.instance;
+	for (int target_id : solution.uncovered_targets) {
+		solver_log(solver, "Uncoverable Target %d (%d,%d), weight %d\n", target_id, instance.target_x[target_id], instance.target_y[target_id],
+				   instance.target_weight[target_id]);
+	}
+	
+	// Track assignments of targets to vehicles (in descending ID order, as results have always been written)
+	for (int vehicle_id = vehicle_count(instance) - 1; vehicle_id >= 0; vehicle_id--) {
+		// Print vehicle information
+		solver_log(solver, "Vehicle %d (%d,%d)\n", vehicle_id, instance.vehicle_x[vehicle_id], instance.vehicle_y[vehicle_id]);
+
+		// Track the number of tours for the current vehicle
+		int tour_count = 1;
 
-			outfile << "\n";
+		// Bids "accepted by auctioneer"
+		for (int column : solution.vehicle_tours[vehicle_id]) {
+			int target_ids[3];
+			int num_column_targets = column_targets(solver.bid_columns, column, target_ids);
+
+			// Print tour count and target locations
+			solver_log(solver, "\tTour %d: ", tour_count++);
+			for (int i = 0; i < num_column_targets; i++) {
+				solver_log(solver, "%sTarget %d (%d,%d)", i > 0 ? ", " : "", target_ids[i], instance.target_x[target_ids[i]], instance.target_y[target_ids[i]]);
+			}
+			solver_log(solver, "\n");
 		}
 
-    	outfile.close();
-    }
+		solver_log(solver, "\n");
+	}
 }
 
 /*
- * Print vehicle-target assignments
- * @param model - Optimized Gurobi model
- * @param instance_name - Name of current problem instance
+ * Solve the exact cover over the current bid columns with the configured backend
+ * The MIP stops at the solver's deadline with its best incumbent (the greedy cover if the deadline leaves no time to
+ * optimize or no incumbent was found); column generation runs without a deadline.
+ * @param solver - CVRP solver holding the bid columns
+ * @param build_start - Start of the bid and model build (for the build time report)
+ * @param solution - Output: decoded solution
  */
-void print_results(GRBModel& model, std::string instance_name) {
-	// Print instance name
-	printf("%s\n", &instance_name[0]);
+void solve_bid_columns(CvrpSolver& solver, std::chrono::steady_clock::time_point build_start, CvrpSolution& solution) {
+	bool solve_mip = solver_backend != SOLVER_BACKEND_MATCHING || use_column_generation;
+	bool solve_matching = solver_backend != SOLVER_BACKEND_MIP && !use_column_generation;
+
+	if (solve_mip) {
+		// Initialize model from the shared solver session
+		GRBModel model = session_model(solver.session, "cvrp");
+
+		// Create bid variables (objective coefficients are set on the bid variables; goal is to minimize)
+		create_bid_variables(solver, model);
+
+		// Create constraints
+		create_constraints(solver, model);
+		model.update();
+
+		// Report model size, build time and memory
+		ModelBuildStats build_stats = {};
+		build_stats.num_columns = solver.bid_vars.size();
+		build_stats.num_nonzeros = solver.bid_columns.cover_row_bids.size();
+		build_stats.build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - build_start).count();
+		build_stats.peak_rss_kb = peak_rss_kb();
+		solver_log(solver, "Model build: %d bids, %lld nonzeros, %.3f s, peak RSS %ld KB\n",
+			   build_stats.num_columns, build_stats.num_nonzeros, build_stats.build_seconds, build_stats.peak_rss_kb);
+
+		// Optimize objective (column generation solves the LP relaxations and the final MIP itself)
+		if (use_column_generation) {
+			ColumnGenerationStats column_generation_stats;
+			int max_columns_per_round = column_generation_max_columns > 0 ? column_generation_max_columns : std::max(1, target_count(solver.instance));
+			bool optimized = run_column_generation(solver.session, model, solver.distance_tables, solver.instance.target_weight, solver.capacity_buckets,
+												   max_bundle_size, max_columns_per_round, solver.bid_columns, solver.bid_vars, solver.cover_constrs,
+												   solver.deadline, column_generation_stats);
+			solver_log(solver, "Column generation: %d rounds, %d seed + %d generated columns, %lld bundles priced, LP bound %f%s, LP %.3f s, pricing %.3f s\n",
+				   column_generation_stats.rounds, column_generation_stats.seed_columns, column_generation_stats.generated_columns,
+				   column_generation_stats.bundles_examined, column_generation_stats.lp_bound,
+				   column_generation_stats.stopped_at_deadline ? " (pricing stopped at the deadline)" : "",
+				   column_generation_stats.lp_seconds, column_generation_stats.pricing_seconds);
+
+			// Decode the final MIP, or fall back to the greedy cover of the generated columns. The final MIP and the
+			// column shares only see the generated columns, so the bound is the LP bound over all bundles (unknown, 0, if
+			// pricing stopped at the deadline)
+			if (optimized && model.get(GRB_IntAttr_SolCount) > 0) {
+				decode_solution(model, solver.bid_columns, solver.bid_vars, vehicle_count(solver.instance), solution);
+				solution.stopped_at_deadline = solution.stopped_at_deadline || column_generation_stats.stopped_at_deadline;
+			} else {
+				std::vector<char> greedy_columns;
+				greedy_savings_cover(solver.bid_columns, greedy_columns);
+				decode_selected_columns(solver.bid_columns, greedy_columns, vehicle_count(solver.instance), solution);
+				solution.stopped_at_deadline = true;
+			}
+			solution.bound = column_generation_stats.lp_bound;
+			if (solution.stopped_at_deadline) {
+				solver.deadline_stops++;
+				solver_log(solver, "Deadline: objective %f, bound %f, gap %.2f%% (column generation)\n", solution.objective, solution.bound,
+						   100 * solution_gap(solution));
+			}
+		} else {
+			// Warm start from the greedy savings cover (also the fallback solution under a deadline), timing the incumbents
+			IncumbentTimer incumbent_timer;
+			std::vector<char> greedy_columns;
+			if (use_greedy_mip_start || solver.deadline.active) {
+				auto greedy_start = std::chrono::steady_clock::now();
+				double greedy_objective = greedy_savings_cover(solver.bid_columns, greedy_columns);
+				if (use_greedy_mip_start) {
+					set_mip_start(model, solver.bid_vars, greedy_columns);
+				}
+				solver_log(solver, "Greedy start: objective %f, %.3f s\n", greedy_objective,
+					   std::chrono::duration<double>(std::chrono::steady_clock::now() - greedy_start).count());
+			}
 
-	// Print minimum sum of tour lengths
-	printf("Minimum Sum of Tour Lengths: %f\n", model.get(GRB_DoubleAttr_ObjVal));
-	
-	// Track assignments of targets to vehicles
-	for (const auto& vehicle_entry : vehicles) {
-		Vehicle vehicle = vehicle_entry.second;
+			bool optimized = seconds_remaining(solver.deadline) > 0;
+			if (optimized) {
+				set_model_deadline(solver.session, model, solver.deadline);
+				model.setCallback(&incumbent_timer);
+				optimize_in_session(solver.session, model);
+				model.setCallback(NULL);
+			}
+			if (incumbent_timer.first_incumbent_seconds >= 0) {
+				solver_log(solver, "First incumbent: objective %f at %.3f s (%d incumbents)\n", incumbent_timer.first_incumbent_objective,
+					   incumbent_timer.first_incumbent_seconds, incumbent_timer.num_incumbents);
+			}
 
-		// Print vehicle information
-		printf("Vehicle %d (%d,%d)\n", vehicle.id, vehicle.depot_location.first, vehicle.depot_location.second);
-
-		if (vehicle_bids.find(vehicle.id) != vehicle_bids.end()) {
-			// Track the number of tours for the current vehicle
-			int tour_count = 1;
-
-			for (auto& bid : vehicle_bids[vehicle.id]) {
-				// Bid has been "accepted by auctioneer"
-				if (bid.get(GRB_DoubleAttr_X) == 1) {
-					std::string bid_var_name = bid.get(GRB_StringAttr_VarName);
-					char* split_element = strtok(&bid_var_name[0], ",");
-					split_element = strtok(NULL, ",");
-					int target_id_1 = std::stoi(split_element);
-					Target target_1 = targets[target_id_1];
-
-					// Print tour count and first target location
-					printf("\tTour %d: Target %d (%d,%d)", tour_count++, target_id_1, target_1.location.first, target_1.location.second);
-
-					// If the tour encompasses two targets, print second target location
-					split_element = strtok(NULL, ",");
-					if (split_element != NULL) {
-						int target_id_2 = std::stoi(split_element);
-						Target target_2 = targets[target_id_2];
-						printf(", Target %d (%d,%d)\n", target_id_2, target_2.location.first, target_2.location.second);
-					} else {
-						printf("\n");
-					}
+			// Decode accepted bids from one bulk solution query, or fall back to the greedy cover (the model may not have
+			// been optimized at all if the deadline had already passed)
+			if (optimized && model.get(GRB_IntAttr_SolCount) > 0) {
+				decode_solution(model, solver.bid_columns, solver.bid_vars, vehicle_count(solver.instance), solution);
+			} else {
+				if (greedy_columns.empty()) {
+					greedy_savings_cover(solver.bid_columns, greedy_columns);
 				}
+				decode_selected_columns(solver.bid_columns, greedy_columns, vehicle_count(solver.instance), solution);
+				double model_bound = optimized ? model.get(GRB_DoubleAttr_ObjBound) : 0;
+				solution.bound = std::max(column_share_bound(solver.bid_columns), std::isfinite(model_bound) ? model_bound : 0);
+				solution.stopped_at_deadline = true;
 			}
+
+			// Anytime profile of a solve stopped by the deadline
+			if (solution.stopped_at_deadline) {
+				solver.deadline_stops++;
+				solver_log(solver, "Deadline: objective %f, bound %f, gap %.2f%% after %d improving incumbents", solution.objective,
+						   solution.bound, 100 * solution_gap(solution), (int) incumbent_timer.incumbents.size());
+				for (const IncumbentRecord& incumbent : incumbent_timer.incumbents) {
+					solver_log(solver, " (%.3f s: %f, bound %f)", incumbent.seconds, incumbent.objective, incumbent.bound);
+				}
+				solver_log(solver, "\n");
+			}
+		}
+	}
+
+	if (solve_matching) {
+		// Exact cover by maximum-weight matching over the same bid columns
+		CvrpSolution matching_solution;
+		MatchingStats matching_stats;
+		solve_cover_by_matching(solver.bid_columns, target_count(solver.instance), vehicle_count(solver.instance), matching_solution, matching_stats);
+		solver_log(solver, "Matching: %d bids, %d savings edges, %d components (largest %d targets), %.3f s\n", (int) solver.bid_columns.tour_lengths.size(),
+			   matching_stats.num_edges, matching_stats.num_components, matching_stats.largest_component, matching_stats.solve_seconds);
+
+		if (!solve_mip) {
+			solution = matching_solution;
 		}
 
-		printf("\n");
+		// Cross-check against the MIP (which stops within its relative MIP gap)
+		else if (std::fabs(solution.objective - matching_solution.objective) > 1e-4 * std::max(1.0, std::fabs(matching_solution.objective))) {
+			solver_log(solver, "Cross-check mismatch: MIP %f, matching %f\n", solution.objective, matching_solution.objective);
+		} else {
+			solver_log(solver, "Cross-check: MIP %f, matching %f\n", solution.objective, matching_solution.objective);
+		}
 	}
+
+	// Spread bundles tied between several vehicles over those vehicles
+	assign_tied_vehicles(solver.bid_columns, solver.bid_ties, solution);
 }
 
 /*
- * Set up and solve CVRP problem with desired problem formulation
+ * Create the bid columns of a formulation for the current instance (its tables already built) and solve them
+ * @param solver - CVRP solver holding the instance and its tables
  * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
- * @param output_file_name - Name of file to output results to
- * @param instance_name - Name of current problem instance
+ * @param solution - Output: decoded solution, with the targets no vehicle can carry
  */
-void cvrp(bool consider_only_best_bid, std::string output_file_name, std::string instance_name) {
-	try {
-		// Initialize environment and suppress output
-		GRBEnv* environment = new GRBEnv();
-		environment -> set(GRB_IntParam_OutputFlag, 0);
+void solve_formulation(CvrpSolver& solver, bool consider_only_best_bid, CvrpSolution& solution) {
+	// Create bids
+	auto build_start = std::chrono::steady_clock::now();
+	create_bids(solver, consider_only_best_bid);
+
+	// Report targets that no vehicle can carry (they have no bids and no cover constraint)
+	std::vector<int> uncovered_targets = uncoverable_targets(solver.bid_columns);
+	if (!uncovered_targets.empty()) {
+		solver_log(solver, "Warning: %d target(s) exceed every vehicle's capacity and cannot be serviced:", (int) uncovered_targets.size());
+		for (int target_id : uncovered_targets) {
+			solver_log(solver, " %d", target_id);
+		}
+		solver_log(solver, "\n");
+	}
 
-		// Initialize model and objective function
-		GRBModel model = GRBModel(*environment);
-		GRBLinExpr* objFunction = new GRBLinExpr();
+	solve_bid_columns(solver, build_start, solution);
+	solution.uncovered_targets = uncovered_targets;
+}
 
-		// Create bids
-		create_singleton_bids(consider_only_best_bid, model, objFunction);
-		create_pair_bids(consider_only_best_bid, model, objFunction);
+/*
+ * Start the time budget of the current instance (ending with the batch's, if that is earlier) and precompute the
+ * distances and capacities shared by all of its bids and formulations
+ * @param solver - CVRP solver holding the instance
+ */
+void start_instance_solve(CvrpSolver& solver) {
+	solver.deadline = earlier_deadline(deadline_after(instance_time_limit), solver.batch_deadline);
+	build_instance_tables(solver);
+}
 
-	    // Goal is to minimize objective function
-	    model.setObjective(*objFunction, GRB_MINIMIZE);
+/*
+ * Solve the current instance of a solver with one formulation, without printing or writing results (Gurobi errors
+ * are left to the caller)
+ * @param solver - CVRP solver holding the instance
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param solution - Output: decoded solution (its columns index solver.bid_columns)
+ */
+void solve_instance(CvrpSolver& solver, bool consider_only_best_bid, CvrpSolution& solution) {
+	start_instance_solve(solver);
+	solve_formulation(solver, consider_only_best_bid, solution);
+}
 
-	    // Create constraints
-	    create_constraints(model);
+/*
+ * Set up and solve CVRP problem with several formulations, sharing the instance precomputation
+ * The distance tables, capacity buckets and candidate pairs are built once. Formulations that generate the same bid
+ * columns (best-bid and all-bids when the formulations collapse) share one bid generation and one solve.
+ * @param solver - CVRP solver holding the instance
+ * @param formulations - Formulations to solve (each with its own output file and encoding)
+ * @param instance_name - Name of current problem instance
+ * @param encoded_results - If not NULL, receives the encoded results of each formulation instead of them being appended to its file
+ * Return the minimum sum of tour lengths of each formulation (-1 if it could not be solved)
+ */
+std::vector<double> cvrp_formulations(CvrpSolver& solver, const std::vector<CvrpFormulation>& formulations, std::string instance_name,
+									 std::vector<std::string>* encoded_results) {
+	std::vector<double> objectives(formulations.size(), -1);
+	if (encoded_results != NULL) {
+		encoded_results->assign(formulations.size(), std::string());
+	}
+
+	try {
+		// Start the instance's time budget and precompute the tables shared by all formulations
+		start_instance_solve(solver);
+
+		std::vector<char> solved(formulations.size(), 0);
+		for (size_t first = 0; first < formulations.size(); first++) {
+			if (solved[first]) {
+				continue;
+			}
 
-	    // Optimize objective
-		model.optimize();
+			// Formulations generating the same bid columns as this one
+			bool best_bids = generates_best_bids_only(formulations[first].consider_only_best_bid);
+			std::vector<int> sharing_formulations;
+			for (size_t other = first; other < formulations.size(); other++) {
+				if (!solved[other] && generates_best_bids_only(formulations[other].consider_only_best_bid) == best_bids) {
+					sharing_formulations.push_back(other);
+					solved[other] = 1;
+				}
+			}
+			if (sharing_formulations.size() > 1) {
+				solver_log(solver, "Shared solve: %d formulations use the same bid columns\n", (int) sharing_formulations.size());
+			}
 
-		// Print results
-		print_results(model, instance_name);
+			// Create bids and solve
+			auto build_start = std::chrono::steady_clock::now();
+			CvrpSolution solution;
+			solve_formulation(solver, formulations[first].consider_only_best_bid, solution);
+			double solve_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - build_start).count();
+
+			ResultRecord record;
+			build_result_record(solver, solution, instance_name, solve_seconds, record);
+			std::string results;
+			for (int formulation : sharing_formulations) {
+				// Print results
+				if (!quiet_results) {
+					print_results(solver, solution, instance_name);
+				}
+
+				// Output results to file
+				encode_result(record, formulations[formulation].encoding, results);
+				if (encoded_results != NULL) {
+					(*encoded_results)[formulation] = results;
+				} else if (!formulations[formulation].output_file_name.empty()) {
+					append_results_to_file(formulations[formulation].output_file_name, formulations[formulation].encoding, results);
+				}
 
-		// Output results to file
-		append_results_to_file(output_file_name, model, instance_name);
+				objectives[formulation] = solution.objective;
+			}
+		}
 	} catch (GRBException e) {
-        std::cout << "Error code = " << e.getErrorCode() << std::endl;
-        std::cout << e.getMessage() << std::endl;
+        solver_log(solver, "Error code = %d\n", e.getErrorCode());
+        solver_log(solver, "%s\n", e.getMessage().c_str());
     } catch (...) {
-        std::cout << "Exception during optimization" << std::endl;
+        solver_log(solver, "Exception during optimization\n");
     }
+
+	return objectives;
 }
 
 /*
- * Reset problem state
+ * Set up and solve CVRP problem with desired problem formulation
+ * @param solver - CVRP solver holding the instance
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param output_file_name - Name of file to output results to
+ * @param instance_name - Name of current problem instance
+ * @param results_text - If not NULL, receives the results file text (legacy text encoding) instead of it being appended to the file
+ * Return the minimum sum of tour lengths (-1 if the instance could not be solved)
  */
-void reset_state() {
-	targets.clear();
-	vehicles.clear();
-	target_ids.clear();
-	vehicle_ids.clear();
-	bids_for_target.clear();
-	vehicle_bids.clear();
+double cvrp(CvrpSolver& solver, bool consider_only_best_bid, std::string output_file_name, std::string instance_name, std::string* results_text) {
+	std::vector<CvrpFormulation> formulations(1, CvrpFormulation{consider_only_best_bid, output_file_name});
+	std::vector<std::string> encoded_results;
+	std::vector<double> objectives = cvrp_formulations(solver, formulations, instance_name, results_text != NULL ? &encoded_results : NULL);
+	if (results_text != NULL) {
+		*results_text = encoded_results[0];
+	}
+
+	return objectives[0];
 }
 
 /*
- * Generate problem instance from input strings
- * @param vehicle_locations_line - String specifying vehicle depot coordinate locations
- * @param target_locations_line - String specifying target coordinate locations
- * @param weights_line - String specifying target weights
+ * Reset problem state (the solver session and distance oracle are kept)
+ * @param solver - CVRP solver to reset
  */
-void generate_instance(std::string vehicle_locations_line, std::string target_locations_line, std::string weights_line) {
-	// Initialize vectors to store instance data
-	std::vector<std::pair<int, int>> vehicle_locations;
-	std::vector<std::pair<int, int>> target_locations;
-	std::vector<int> weights;
-
-	// Parse vehicle location data
-	char *vehicle_locations_save_pointer;
-	char* vehicle_location = strtok_r(&vehicle_locations_line[0], ";", &vehicle_locations_save_pointer);
-	while (vehicle_location != NULL) {
-		char *coordinates_save_pointer;
-		char* x_coor = strtok_r(vehicle_location, ",", &coordinates_save_pointer);
-		char* y_coor = strtok_r(NULL, ",", &coordinates_save_pointer);
-		vehicle_locations.push_back(std::make_pair(std::stoi(x_coor), std::stoi(y_coor)));
-		vehicle_location = strtok_r(NULL, ";", &vehicle_locations_save_pointer);
-	}
-
-	// Parse target location data
-	char *target_locations_save_pointer;
-	char* target_location = strtok_r(&target_locations_line[0], ";", &target_locations_save_pointer);
-	while (target_location != NULL) {
-		char *coordinates_save_pointer;
-		char* x_coor = strtok_r(target_location, ",", &coordinates_save_pointer);
-		char* y_coor = strtok_r(NULL, ",", &coordinates_save_pointer);
-		target_locations.push_back(std::make_pair(std::stoi(x_coor), std::stoi(y_coor)));
-		target_location = strtok_r(NULL, ";", &target_locations_save_pointer);
-	}
+void reset_state(CvrpSolver& solver) {
+	clear_instance(solver.instance);
+	solver.bid_columns = BidColumns();
+	solver.bid_vars.clear();
+	solver.bid_ties = TiedVehicles();
+	solver.cover_constrs.clear();
+	solver.distance_tables = DistanceTables();
+	solver.capacity_buckets = CapacityBuckets();
+	solver.depot_grid = SpatialGrid();
+	solver.use_depot_grid = false;
+	solver.candidate_pairs = CandidatePairs();
+}
 
-	// Parse weight data
-	char* weight = strtok(&weights_line[0], ",");
-	while (weight != NULL) {
-		weights.push_back(std::stoi(weight));
-		weight = strtok(NULL, ",");
-	}
+/*
+ * Generate problem instance from parsed dataset data
+ * @param solver - CVRP solver to generate the instance into
+ * @param instance - Parsed vehicle depot locations, target locations, target weights and (binary format) capacities
+ */
+void generate_instance(CvrpSolver& solver, const ParsedInstance& instance) {
+	reserve_instance(solver.instance, instance.target_locations.size(), instance.vehicle_locations.size());
 
 	// Generate targets
-	for (int i = 0; i < target_locations.size(); i++) {
-		Target new_target = {};
-		int x_coor = target_locations[i].first;
-		int y_coor = target_locations[i].second;
-		new_target.location = std::make_pair(x_coor, y_coor);
-		new_target.weight = weights[i];
-		new_target.id = i;
-		targets.insert(std::make_pair(new_target.id, new_target));
-		target_ids.push_back(new_target.id);
+	for (size_t i = 0; i < instance.target_locations.size(); i++) {
+		add_target(solver.instance, instance.target_locations[i], instance.weights[i]);
 	}
 
 	// Generate vehicles
-	for (int i = 0; i < vehicle_locations.size(); i++) {
-		Vehicle new_vehicle = {};
-		int x_coor = vehicle_locations[i].first;
-		int y_coor = vehicle_locations[i].second;
-		new_vehicle.depot_location = std::make_pair(x_coor, y_coor);
+	for (size_t i = 0; i < instance.vehicle_locations.size(); i++) {
 
 
 
@@ -536,7 +704,7 @@ void generate_instance(std::string vehicle_locations_line, std::string target_lo
 
 
 		// INVESTIGATE VEHICLE CAPACITITES!!!
-		new_vehicle.capacity = 100;
+		int capacity = instance.capacities.empty() ? DEFAULT_VEHICLE_CAPACITY : instance.capacities[i];
 
 
 
@@ -544,9 +712,181 @@ void generate_instance(std::string vehicle_locations_line, std::string target_lo
 
 
 		
-		new_vehicle.id = i;
-		vehicles.insert(std::make_pair(new_vehicle.id, new_vehicle));
-		vehicle_ids.push_back(new_vehicle.id);
+		add_vehicle(solver.instance, instance.vehicle_locations[i], capacity);
+	}
+}
+
+/*
+ * Load a dataset record of a mapped file and generate it into a solver (after clearing the solver's problem state)
+ * @param solver - CVRP solver to generate the instance into
+ * @param file - Mapped and indexed instance file (text or binary)
+ * @param dataset_number - Record number (0-based)
+ * @param dataset_name - Output: name of the data set
+ * Return false (after logging the error) if the record is malformed
+ */
+bool load_dataset_instance(CvrpSolver& solver, const DatasetFile& file, int dataset_number, std::string& dataset_name) {
+	// Clear problem state
+	reset_state(solver);
+
+	ParsedInstance instance;
+	try {
+		load_dataset(file, dataset_number, instance);
+	} catch (const std::exception& e) {
+		solver_log(solver, "Skipping malformed data set: %s\n", e.what());
+		return false;
+	}
+
+	// Generate specified problem instance
+	generate_instance(solver, instance);
+	dataset_name = instance.name;
+	return true;
+}
+
+/*
+ * Read CVRP problem instances from file and hand each one to a solve function
+ * @param solver - CVRP solver each instance is generated into
+ * @param input_file_name - Name of input data file
+ * @param solve_instance - Called with the dataset name once the instance has been generated into the solver
+ */
+void for_each_dataset_instance(CvrpSolver& solver, std::string input_file_name, const std::function<void(std::string)>& solve_instance) {
+	// Map and index the input instance file (text or binary)
+	DatasetFile file;
+	try {
+		if (!open_instance_file(input_file_name, file)) {
+			return;
+		}
+	} catch (const std::exception& e) {
+		solver_log(solver, "%s\n", e.what());
+		close_dataset_file(file);
+		return;
+	}
+
+	// Read datasets iteratively
+	std::string dataset_name;
+	for (int dataset_number = 0; dataset_number < (int) file.index.size(); dataset_number++) {
+		if (load_dataset_instance(solver, file, dataset_number, dataset_name)) {
+			// Solve problem instance
+			solve_instance(dataset_name);
+		}
+	}
+
+	close_dataset_file(file);
+}
+
+/*
+ * Read CVRP problem instances from file once and solve each with every requested formulation
+ * Each instance is parsed and precomputed once and shared by the formulations (see cvrp_formulations). Instances are
+ * solved concurrently by batch_threads workers, each with its own solver (and Gurobi environment); printed output and
+ * the results of each formulation are written in input order, through one buffered result sink per results file.
+ * With a batch time limit, instances still running when it ends emit their best incumbent, and instances started after
+ * it emit their greedy cover.
+ * @param formulations - Formulations to solve (each with its own output file and encoding)
+ * @param input_file_name - Name of input data file
+ */
+void dataset_cvrp(const std::vector<CvrpFormulation>& formulations, std::string input_file_name) {
+	// Map and index the input instance file, text or binary (workers load their own records from the mapping)
+	DatasetFile file;
+	try {
+		if (!open_instance_file(input_file_name, file)) {
+			return;
+		}
+	} catch (const std::exception& e) {
+		printf("%s\n", e.what());
+		close_dataset_file(file);
+		return;
+	}
+	int num_records = file.index.size();
+
+	int num_workers = batch_threads > 0 ? batch_threads : std::max(1, (int) std::thread::hardware_concurrency());
+	num_workers = std::max(1, std::min(num_workers, num_records));
+
+	// One solver per worker; with several workers each solve is single-threaded so the workers use every core
+	SolveDeadline batch_deadline = deadline_after(batch_time_limit);
+	std::vector<CvrpSolver> solvers(num_workers);
+	for (CvrpSolver& solver : solvers) {
+		solver.session.parameters = cvrp_solver.session.parameters;
+		solver.batch_deadline = batch_deadline;
+		solver.buffer_log = true;
+		if (num_workers > 1) {
+			solver.bid_generation_threads = 1;
+			if (solver.session.parameters.threads == 0) {
+				solver.session.parameters.threads = 1;
+			}
+		}
+	}
+
+	// Finished instances (printed output and encoded results) wait here until all earlier ones are written
+	std::vector<std::string> logs(num_records);
+	std::vector<std::vector<std::string>> results(num_records);
+	std::vector<char> finished(num_records, 0);
+	std::mutex finished_mutex;
+	std::condition_variable finished_condition;
+	std::atomic<int> next_record(0);
+
+	std::vector<std::thread> workers;
+	for (int worker = 0; worker < num_workers; worker++) {
+		workers.push_back(std::thread([&, worker]() {
+			CvrpSolver& solver = solvers[worker];
+			for (int index = next_record++; index < num_records; index = next_record++) {
+				std::string dataset_name;
+				if (load_dataset_instance(solver, file, index, dataset_name)) {
+					cvrp_formulations(solver, formulations, dataset_name, &results[index]);
+				} else {
+					results[index].assign(formulations.size(), std::string());
+				}
+
+				std::lock_guard<std::mutex> lock(finished_mutex);
+				logs[index].swap(solver.log);
+				finished[index] = 1;
+				finished_condition.notify_one();
+			}
+
+			// Release the instance state early (the session is closed after the batch)
+			reset_state(solver);
+		}));
+	}
+
+	// Write instances in input order as they finish
+	std::vector<ResultSink> sinks(formulations.size());
+	for (size_t formulation = 0; formulation < formulations.size(); formulation++) {
+		if (!formulations[formulation].output_file_name.empty()) {
+			open_result_sink(sinks[formulation], formulations[formulation].output_file_name, formulations[formulation].encoding);
+		}
+	}
+	for (int index = 0; index < num_records; index++) {
+		std::unique_lock<std::mutex> lock(finished_mutex);
+		finished_condition.wait(lock, [&]() {
+			return finished[index] != 0;
+		});
+		lock.unlock();
+
+		fputs(logs[index].c_str(), stdout);
+		for (size_t formulation = 0; formulation < formulations.size(); formulation++) {
+			write_result(sinks[formulation], results[index][formulation]);
+		}
+		std::string().swap(logs[index]);
+		std::vector<std::string>().swap(results[index]);
+	}
+	for (ResultSink& sink : sinks) {
+		close_result_sink(sink);
+	}
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	close_dataset_file(file);
+
+	// Report the solver overhead per instance and the solves cut short by deadlines
+	SolverSessionStats session_stats;
+	int deadline_stops = 0;
+	for (CvrpSolver& solver : solvers) {
+		add_session_stats(session_stats, solver.session.stats);
+		close_solver_session(solver.session);
+		deadline_stops += solver.deadline_stops;
+	}
+	print_session_overhead(session_stats, SolverSessionStats(), num_records);
+	if (instance_time_limit > 0 || batch_time_limit > 0) {
+		printf("Deadlines: %d of %d instance solves stopped early\n", deadline_stops, num_records);
 	}
 }
 
@@ -557,37 +897,54 @@ void generate_instance(std::string vehicle_locations_line, std::string target_lo
  * @param output_file_name - Name of file to output results to
  */
 void dataset_cvrp(bool consider_only_best_bid, std::string input_file_name, std::string output_file_name) {
-	// Create input stream for input dataset file
-    std::ifstream infile(input_file_name);
-
-    if (infile.is_open()) {
-    	// Initialize variables for each problem instance
-    	std::string dataset_name_line;
-    	std::string vehicle_locations_line;
-    	std::string target_locations_line;
-    	std::string weights_line;
-
-        // Read datasets iteratively
-        while (std::getline(infile, dataset_name_line)) {
-        	std::getline(infile, vehicle_locations_line);
-        	std::getline(infile, target_locations_line);
-        	std::getline(infile, weights_line);
-
-        	// Remove labels
-        	vehicle_locations_line = vehicle_locations_line.substr(vehicle_locations_line.find_first_of(":") + 1);
-        	target_locations_line = target_locations_line.substr(target_locations_line.find_first_of(":") + 1);
-        	weights_line = weights_line.substr(weights_line.find_first_of("=") + 2);
-
-			// Clear problem state
-			reset_state();
-
-        	// Generate specified problem instance
-        	generate_instance(vehicle_locations_line, target_locations_line, weights_line);
-
-        	// Solve problem instance and append results to file
-        	cvrp(consider_only_best_bid, output_file_name, dataset_name_line);
-        }
-
-        infile.close();
-    }
+	dataset_cvrp(std::vector<CvrpFormulation>(1, CvrpFormulation{consider_only_best_bid, output_file_name}), input_file_name);
+}
+
+/*
+ * Solve every dataset instance with all pairs and with k-nearest-neighbour candidate pairs, and report the objective
+ * degradation of the heuristic mode (one line per instance, then a summary)
+ * @param consider_only_best_bid - Flag indicating whether to consider only the best bid for each itemset or all of them
+ * @param k - Number of neighbours per target
+ * @param input_file_name - Name of input data file
+ * @param report_file_name - Name of file to write the report to
+ */
+void knn_degradation_report(bool consider_only_best_bid, int k, std::string input_file_name, std::string report_file_name) {
+	std::ofstream outfile(report_file_name);
+	int previous_k = pair_neighbours_k;
+	int num_instances = 0;
+	int num_degraded = 0;
+	double total_gap = 0;
+	double max_gap = 0;
+
+	outfile << "k = " << k << "\n";
+	for_each_dataset_instance(cvrp_solver, input_file_name, [&](std::string dataset_name) {
+		pair_neighbours_k = 0;
+		double full_objective = cvrp(cvrp_solver, consider_only_best_bid, "", dataset_name);
+		int full_columns = cvrp_solver.bid_columns.tour_lengths.size();
+
+		pair_neighbours_k = k;
+		double knn_objective = cvrp(cvrp_solver, consider_only_best_bid, "", dataset_name);
+		int knn_columns = cvrp_solver.bid_columns.tour_lengths.size();
+
+		if (full_objective < 0 || knn_objective < 0) {
+			outfile << dataset_name << ": not solved\n";
+			return;
+		}
+
+		// Relative objective increase of the heuristic (percent)
+		double gap = full_objective > 0 ? 100.0 * (knn_objective - full_objective) / full_objective : 0;
+		outfile << dataset_name << ": full " << full_objective << " (" << full_columns << " bids), k-NN " << knn_objective
+				<< " (" << knn_columns << " bids), gap " << gap << "%\n";
+
+		num_instances++;
+		num_degraded += gap > 1e-9;
+		total_gap += gap;
+		max_gap = std::max(max_gap, gap);
+	});
+
+	pair_neighbours_k = previous_k;
+	outfile << "Instances: " << num_instances << ", degraded: " << num_degraded
+			<< ", mean gap: " << (num_instances > 0 ? total_gap / num_instances : 0) << "%, max gap: " << max_gap << "%\n";
+	printf("k-NN pair mode (k = %d): %d instances, %d degraded, mean gap %f%%, max gap %f%%\n",
+		   k, num_instances, num_degraded, num_instances > 0 ? total_gap / num_instances : 0, max_gap);
 }
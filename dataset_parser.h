@@ -0,0 +1,301 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/*
+ * Memory-mapped parser for the CVRP dataset text format
+ *   Data set #<n>
+ *   Vehicle locations :x,y;x,y;...;
+ *   Target locations :x,y;x,y;...;
+ *   Weights = w,w,...
+ * The file is mapped read-only and indexed once (byte offset and line number of each record), so any dataset can be
+ * parsed by number without reading the ones before it. Numbers are parsed with std::from_chars straight from the
+ * mapped bytes; the only string built per record is its name. A UTF-8 byte order mark, '\r' line endings and blank
+ * lines between records are accepted. Malformed records throw a DatasetFormatError naming the file and line.
+ */
+
+struct DatasetFormatError : public std::runtime_error {
+	int line_number;
+
+	DatasetFormatError(const std::string& file_name, int line_number, const std::string& message)
+		: std::runtime_error(file_name + ":" + std::to_string(line_number) + ": " + message), line_number(line_number) {}
+};
+
+struct DatasetIndexEntry {
+	size_t	offset;			// Byte offset of the record's name line
+	int		line_number;	// Line number of the record's name line (1-based)
+};
+
+struct DatasetFile {
+	std::string						file_name;
+	const char*						data = NULL;	// Mapped file contents (NULL for an empty file)
+	size_t							size = 0;
+	bool							binary = false;	// Binary instance format (binary_instances.h) rather than text
+	std::vector<DatasetIndexEntry>	index;			// One entry per record, in file order
+};
+
+struct ParsedInstance {
+	std::string							name;
+	std::vector<std::pair<int, int>>	vehicle_locations;
+	std::vector<std::pair<int, int>>	target_locations;
+	std::vector<int>					weights;
+	std::vector<int>					capacities;		// Vehicle capacities (empty for the text format, which has none)
+};
+
+/*
+ * Return the end of the line starting at a position (the '\n' or the end of the data)
+ * @param data, size - Mapped data
+ * @param position - Start of the line
+ */
+size_t dataset_line_end(const char* data, size_t size, size_t position) {
+	const void* newline = memchr(data + position, '\n', size - position);
+	return newline != NULL ? (const char*) newline - data : size;
+}
+
+/*
+ * Index the records of a mapped dataset file (four non-blank lines each)
+ * @param file - Mapped dataset file (index is filled)
+ */
+void index_dataset_file(DatasetFile& file) {
+	file.index.clear();
+	size_t position = file.size >= 3 && memcmp(file.data, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+	int line_number = 1;
+	int record_line = 0;
+
+	while (position < file.size) {
+		size_t line_end = dataset_line_end(file.data, file.size, position);
+		bool blank = true;
+		for (size_t i = position; i < line_end && blank; i++) {
+			blank = file.data[i] == ' ' || file.data[i] == '\t' || file.data[i] == '\r';
+		}
+
+		if (!blank || record_line > 0) {
+			if (blank) {
+				throw DatasetFormatError(file.file_name, line_number, "blank line inside a data set record");
+			}
+			if (record_line == 0) {
+				DatasetIndexEntry entry = {position, line_number};
+				file.index.push_back(entry);
+			}
+			record_line = (record_line + 1) % 4;
+		}
+
+		position = line_end + 1;
+		line_number++;
+	}
+
+	if (record_line != 0) {
+		throw DatasetFormatError(file.file_name, line_number - 1, "incomplete data set record at end of file");
+	}
+}
+
+/*
+ * Map a file read-only
+ * @param file_name - Name of the file
+ * @param data - Output: mapped contents (NULL for an empty file)
+ * @param size - Output: file size
+ * Return false if the file could not be opened or mapped
+ */
+bool map_file(const std::string& file_name, const char*& data, size_t& size) {
+	data = NULL;
+	size = 0;
+	int descriptor = open(file_name.c_str(), O_RDONLY);
+	if (descriptor < 0) {
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(descriptor, &file_stat) != 0) {
+		close(descriptor);
+		return false;
+	}
+
+	if (file_stat.st_size > 0) {
+		void* mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapping == MAP_FAILED) {
+			close(descriptor);
+			return false;
+		}
+		madvise(mapping, file_stat.st_size, MADV_SEQUENTIAL);
+		data = (const char*) mapping;
+		size = file_stat.st_size;
+	}
+	close(descriptor);
+	return true;
+}
+
+/*
+ * Map a dataset file read-only and index its records
+ * @param file_name - Name of the dataset file
+ * @param file - Output: mapped and indexed dataset file
+ * Return false if the file could not be opened or mapped
+ */
+bool open_dataset_file(const std::string& file_name, DatasetFile& file) {
+	file = DatasetFile();
+	file.file_name = file_name;
+	if (!map_file(file_name, file.data, file.size)) {
+		return false;
+	}
+
+	index_dataset_file(file);
+	return true;
+}
+
+/*
+ * Unmap a dataset file
+ * @param file - Mapped dataset file
+ */
+void close_dataset_file(DatasetFile& file) {
+	if (file.data != NULL) {
+		munmap((void*) file.data, file.size);
+	}
+	file.data = NULL;
+	file.size = 0;
+	file.index.clear();
+}
+
+/*
+ * Cursor over one line of a mapped record, reporting errors with the line and column
+ */
+struct DatasetLineParser {
+	const DatasetFile*	file;
+	const char*			line_start;
+	const char*			position;
+	const char*			end;			// End of the line (before any '\r')
+	int					line_number;
+
+	void fail(const std::string& message) const {
+		throw DatasetFormatError(file->file_name, line_number, message + " (column " + std::to_string(position - line_start + 1) + ")");
+	}
+
+	void skip_spaces() {
+		while (position < end && (*position == ' ' || *position == '\t')) {
+			position++;
+		}
+	}
+
+	// Skip a label up to and including its separator (e.g. "Vehicle locations :"), checking its first word
+	void skip_label(const char* expected_label, char separator) {
+		size_t label_length = strlen(expected_label);
+		if ((size_t) (end - position) < label_length || memcmp(position, expected_label, label_length) != 0) {
+			fail(std::string("expected '") + expected_label + "'");
+		}
+
+		const char* separator_position = (const char*) memchr(position, separator, end - position);
+		if (separator_position == NULL) {
+			fail(std::string("expected '") + separator + "' after '" + expected_label + "'");
+		}
+		position = separator_position + 1;
+	}
+
+	int parse_int() {
+		skip_spaces();
+		int value = 0;
+		std::from_chars_result result = std::from_chars(position, end, value);
+		if (result.ec != std::errc()) {
+			fail(result.ec == std::errc::result_out_of_range ? "integer out of range" : "expected an integer");
+		}
+		position = result.ptr;
+		return value;
+	}
+
+	// Parse "x,y;x,y;..." (the final ';' is optional)
+	void parse_locations(std::vector<std::pair<int, int>>& locations) {
+		locations.clear();
+		skip_spaces();
+		while (position < end) {
+			int x = parse_int();
+			skip_spaces();
+			if (position == end || *position != ',') {
+				fail("expected ',' between coordinates");
+			}
+			position++;
+			int y = parse_int();
+			locations.push_back(std::make_pair(x, y));
+
+			skip_spaces();
+			if (position < end && *position != ';') {
+				fail("expected ';' after a location");
+			}
+			position += position < end;
+			skip_spaces();
+		}
+	}
+
+	// Parse "w,w,..." (a final ',' is tolerated)
+	void parse_integers(std::vector<int>& values) {
+		values.clear();
+		skip_spaces();
+		while (position < end) {
+			values.push_back(parse_int());
+			skip_spaces();
+			if (position < end && *position != ',') {
+				fail("expected ',' between values");
+			}
+			position += position < end;
+			skip_spaces();
+		}
+	}
+};
+
+/*
+ * Return a parser over the next line of a record and advance the record position past it
+ * @param file - Mapped dataset file
+ * @param position - Byte offset of the line (advanced to the next line)
+ * @param line_number - Line number of the line (advanced to the next line)
+ */
+DatasetLineParser next_dataset_line(const DatasetFile& file, size_t& position, int& line_number) {
+	size_t line_end = dataset_line_end(file.data, file.size, position);
+	DatasetLineParser line = {&file, file.data + position, file.data + position, file.data + line_end, line_number};
+	if (line.end > line.line_start && line.end[-1] == '\r') {
+		line.end--;
+	}
+
+	position = line_end + 1;
+	line_number++;
+	return line;
+}
+
+/*
+ * Parse one record of a mapped dataset file
+ * @param file - Mapped and indexed dataset file
+ * @param dataset_number - Record number (0-based position in the index)
+ * @param instance - Output: parsed instance
+ */
+void parse_dataset(const DatasetFile& file, int dataset_number, ParsedInstance& instance) {
+	if (dataset_number < 0 || dataset_number >= (int) file.index.size()) {
+		throw std::out_of_range(file.file_name + ": no data set number " + std::to_string(dataset_number));
+	}
+
+	size_t position = file.index[dataset_number].offset;
+	int line_number = file.index[dataset_number].line_number;
+
+	DatasetLineParser name_line = next_dataset_line(file, position, line_number);
+	instance.name.assign(name_line.line_start, name_line.end);
+
+	DatasetLineParser vehicles_line = next_dataset_line(file, position, line_number);
+	vehicles_line.skip_label("Vehicle locations", ':');
+	vehicles_line.parse_locations(instance.vehicle_locations);
+
+	DatasetLineParser targets_line = next_dataset_line(file, position, line_number);
+	targets_line.skip_label("Target locations", ':');
+	targets_line.parse_locations(instance.target_locations);
+
+	DatasetLineParser weights_line = next_dataset_line(file, position, line_number);
+	weights_line.skip_label("Weights", '=');
+	weights_line.parse_integers(instance.weights);
+	instance.capacities.clear();
+
+	if (instance.weights.size() != instance.target_locations.size()) {
+		throw DatasetFormatError(file.file_name, weights_line.line_number, std::to_string(instance.weights.size()) + " weights for "
+								 + std::to_string(instance.target_locations.size()) + " target locations");
+	}
+}
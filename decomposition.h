@@ -0,0 +1,597 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include "cvrp.h"
+
+/*
+ * Spatial decomposition for very large instances
+ * The targets are split by recursive bisection (at the median of the longer side of their bounding box) until every
+ * region holds at most decomposition_max_region_targets targets. Depots are not partitioned: vehicles are not coupled
+ * in the cover model, so every region bids with the whole fleet and a region's best bids are the instance's best bids
+ * for its bundles. Depots provably beaten on every bundle of a region are left out of its solve.
+ * Regions are solved with the regular pipeline (solve_instance) on a pool of workers, each with its own solver; the
+ * summary reports the tasks' process CPU time against the wall time of the region and repair phases (their achieved
+ * parallelism). Only pairs across a split line are lost; the repair step then walks the splits bottom-up and re-solves
+ * the tours near each split line, merged across it in windows along the line, keeping a window's new tours only when
+ * they are shorter.
+ * Lower bound: splitting every tour across a split line evenly between its targets, the tours of an optimal solution
+ * restricted to a region cover it at no more than the region's optimum with an extra singleton per target t priced at
+ * a bound on half a pair tour with a target u of another region:
+ *   max(dmin(t) + d(t, u) + dmin(u), 2 d(t, u), 2 dmin(t), 2 dmin(u)) / 2   (dmin = nearest feasible depot distance)
+ * checked for the k nearest targets and bounded for all farther ones by the k-th nearest distance. The regions' bound
+ * solves (their own columns, singletons lowered to that price) sum to a lower bound on the whole instance. Pairs within
+ * a region missing from its columns (pair_neighbours_k) are priced the same way; under column generation every target
+ * is only charged its cheapest share of any bundle.
+ */
+
+// Configuration
+int											decomposition_max_region_targets = 300;	// Largest region (and repair window)
+double										decomposition_border_width = 0;		// Distance from a split line re-solved by the repair (0 = mean nearest-depot distance)
+bool										decomposition_repair = true;			// Re-solve the tours near split lines
+int											decomposition_bound_neighbours = 8;	// Nearest targets checked for cross-region pairs in the lower bound
+int											decomposition_threads = 0;			// Region workers (0 = one per hardware thread)
+
+struct BisectionNode {
+	int		begin;			// Targets of the node are order[begin, end)
+	int		end;
+	int		middle;			// First target of the second child (end for regions)
+	int		axis;			// Split coordinate: 0 = x, 1 = y
+	int		split;			// Coordinate of the split line
+	int		depth;
+};
+
+struct DecomposedTour {
+	int		vehicle_id;
+	double	tour_length;
+	int		num_targets;
+	int		target_ids[3];
+	bool	replaced;		// Superseded by a repair
+};
+
+struct DecompositionStats {
+	int		regions;
+	int		repair_windows;
+	int		improved_windows;
+	double	region_objective;		// Tour sum before the repair
+	double	objective;
+	double	bound;
+	double	region_seconds;
+	double	repair_seconds;
+	bool	stopped_at_deadline;	// Some region or repair solve stopped at the deadline
+	double	worker_seconds;			// Process CPU time of the region and repair tasks (workers and their solver threads)
+	double	total_seconds;
+};
+
+/*
+ * Return a coordinate of a target
+ * @param instance - Instance
+ * @param target_id - Target ID
+ * @param axis - 0 = x, 1 = y
+ */
+int target_coordinate(const Instance& instance, int target_id, int axis) {
+	return axis == 0 ? instance.target_x[target_id] : instance.target_y[target_id];
+}
+
+/*
+ * Split the targets of an instance by recursive bisection
+ * @param instance - Instance
+ * @param max_region_targets - Largest region
+ * @param order - Output: target IDs, every node's targets contiguous
+ * @param nodes - Output: bisection tree (root first; regions are the nodes with middle == end)
+ */
+void bisect_targets(const Instance& instance, int max_region_targets, std::vector<int>& order, std::vector<BisectionNode>& nodes) {
+	order.resize(target_count(instance));
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		order[target_id] = target_id;
+	}
+
+	nodes.clear();
+	BisectionNode root = {0, target_count(instance), target_count(instance), 0, 0, 0};
+	nodes.push_back(root);
+	for (size_t node_index = 0; node_index < nodes.size(); node_index++) {
+		BisectionNode node = nodes[node_index];
+		if (node.end - node.begin <= std::max(1, max_region_targets)) {
+			continue;
+		}
+
+		// Split the longer side of the bounding box at the median target (by coordinate, then ID)
+		int min_x = instance.target_x[order[node.begin]], max_x = min_x, min_y = instance.target_y[order[node.begin]], max_y = min_y;
+		for (int i = node.begin; i < node.end; i++) {
+			min_x = std::min(min_x, instance.target_x[order[i]]);
+			max_x = std::max(max_x, instance.target_x[order[i]]);
+			min_y = std::min(min_y, instance.target_y[order[i]]);
+			max_y = std::max(max_y, instance.target_y[order[i]]);
+		}
+		node.axis = max_x - min_x >= max_y - min_y ? 0 : 1;
+		node.middle = node.begin + (node.end - node.begin) / 2;
+		std::nth_element(order.begin() + node.begin, order.begin() + node.middle, order.begin() + node.end, [&](int target_id_1, int target_id_2) {
+			int coordinate_1 = target_coordinate(instance, target_id_1, node.axis);
+			int coordinate_2 = target_coordinate(instance, target_id_2, node.axis);
+			return coordinate_1 < coordinate_2 || (coordinate_1 == coordinate_2 && target_id_1 < target_id_2);
+		});
+		node.split = target_coordinate(instance, order[node.middle], node.axis);
+		nodes[node_index] = node;
+
+		BisectionNode first_child = {node.begin, node.middle, node.middle, 0, 0, node.depth + 1};
+		BisectionNode second_child = {node.middle, node.end, node.end, 0, 0, node.depth + 1};
+		nodes.push_back(first_child);
+		nodes.push_back(second_child);
+	}
+}
+
+/*
+ * Run tasks on a pool of workers, each with its own solver
+ * @param solvers - One solver per worker
+ * @param num_tasks - Number of tasks
+ * @param task - Called with a worker's solver and a task index
+ * Return the process CPU time spent on the tasks (the workers and the solver threads they start)
+ */
+double run_decomposition_tasks(std::vector<CvrpSolver>& solvers, int num_tasks, const std::function<void(CvrpSolver&, int)>& task) {
+	timespec cpu_start;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+
+	std::atomic<int> next_task(0);
+	std::vector<std::thread> workers;
+	for (size_t worker = 0; worker < solvers.size() && (int) worker < num_tasks; worker++) {
+		workers.push_back(std::thread([&, worker]() {
+			for (int index = next_task++; index < num_tasks; index = next_task++) {
+				task(solvers[worker], index);
+			}
+		}));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	timespec cpu_end;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_end);
+	return (cpu_end.tv_sec - cpu_start.tv_sec) + 1e-9 * (cpu_end.tv_nsec - cpu_start.tv_nsec);
+}
+
+/*
+ * Select the vehicles able to make a best bid for some bundle of a set of targets: a vehicle whose depot is farther
+ * from the targets' bounding box than another depot of at least its capacity is from its farthest corner, plus the
+ * box's diagonal, is beaten on every bundle by that depot
+ * @param instance - Instance
+ * @param buckets - Capacity buckets of the instance's vehicles
+ * @param target_ids - Targets
+ * @param vehicle_ids - Output: selected vehicle IDs, ascending
+ */
+void select_subset_vehicles(const Instance& instance, const CapacityBuckets& buckets, const std::vector<int>& target_ids, std::vector<int>& vehicle_ids) {
+	vehicle_ids.clear();
+	if (target_ids.empty()) {
+		return;
+	}
+
+	int min_x = instance.target_x[target_ids[0]], max_x = min_x, min_y = instance.target_y[target_ids[0]], max_y = min_y;
+	for (int target_id : target_ids) {
+		min_x = std::min(min_x, instance.target_x[target_id]);
+		max_x = std::max(max_x, instance.target_x[target_id]);
+		min_y = std::min(min_y, instance.target_y[target_id]);
+		max_y = std::max(max_y, instance.target_y[target_id]);
+	}
+	double diagonal = sqrt((double) (max_x - min_x) * (max_x - min_x) + (double) (max_y - min_y) * (max_y - min_y));
+
+	// Buckets in descending capacity: a depot competes with the nearest farthest corner among its bucket and larger ones
+	std::vector<char> selected(vehicle_count(instance), 0);
+	double nearest_farthest = std::numeric_limits<double>::infinity();
+	for (size_t bucket = 0; bucket < buckets.capacities.size(); bucket++) {
+		int bucket_begin = bucket == 0 ? 0 : buckets.bucket_end[bucket - 1];
+		for (int slot = bucket_begin; slot < buckets.bucket_end[bucket]; slot++) {
+			int vehicle_id = buckets.vehicle_order[slot];
+			double far_x = std::max(std::abs(instance.vehicle_x[vehicle_id] - min_x), std::abs(instance.vehicle_x[vehicle_id] - max_x));
+			double far_y = std::max(std::abs(instance.vehicle_y[vehicle_id] - min_y), std::abs(instance.vehicle_y[vehicle_id] - max_y));
+			nearest_farthest = std::min(nearest_farthest, sqrt(far_x * far_x + far_y * far_y));
+		}
+		for (int slot = bucket_begin; slot < buckets.bucket_end[bucket]; slot++) {
+			int vehicle_id = buckets.vehicle_order[slot];
+			double near_x = std::max(0, std::max(min_x - instance.vehicle_x[vehicle_id], instance.vehicle_x[vehicle_id] - max_x));
+			double near_y = std::max(0, std::max(min_y - instance.vehicle_y[vehicle_id], instance.vehicle_y[vehicle_id] - max_y));
+			selected[vehicle_id] = sqrt(near_x * near_x + near_y * near_y) <= nearest_farthest + diagonal;
+		}
+	}
+
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+		if (selected[vehicle_id]) {
+			vehicle_ids.push_back(vehicle_id);
+		}
+	}
+}
+
+/*
+ * Solve the sub-instance of a set of targets (with the vehicles able to bid on them) and return its tours
+ * @param solver - Worker solver (its problem state is replaced)
+ * @param instance - Full instance
+ * @param buckets - Capacity buckets of the instance's vehicles
+ * @param target_ids - Targets of the sub-instance
+ * @param tours - Output: tours of the solution (target and vehicle IDs of the full instance)
+ * @param stopped_at_deadline - Output: whether the solve (or the re-solve) stopped at the deadline
+ * @param singleton_prices - If not NULL, also re-solve the sub-instance with each target's singleton bids priced at most
+ * 						   at its entry, and return the lower bound of that solve in bound
+ * @param bound - Output: lower bound of the re-solve
+ * Return the tour sum (-1 if the sub-instance could not be solved)
+ */
+double solve_target_subset(CvrpSolver& solver, const Instance& instance, const CapacityBuckets& buckets, const std::vector<int>& target_ids,
+						   std::vector<DecomposedTour>& tours, bool& stopped_at_deadline, const std::vector<double>* singleton_prices, double* bound) {
+	std::vector<int> vehicle_ids;
+	select_subset_vehicles(instance, buckets, target_ids, vehicle_ids);
+
+	reset_state(solver);
+	reserve_instance(solver.instance, target_ids.size(), vehicle_ids.size());
+	for (int target_id : target_ids) {
+		add_target(solver.instance, target_location(instance, target_id), instance.target_weight[target_id]);
+	}
+	for (int vehicle_id : vehicle_ids) {
+		add_vehicle(solver.instance, vehicle_location(instance, vehicle_id), instance.vehicle_capacity[vehicle_id]);
+	}
+
+	CvrpSolution solution;
+	CvrpSolution bound_solution;
+	stopped_at_deadline = false;
+	try {
+		solve_instance(solver, true, solution);
+		if (singleton_prices != NULL) {
+			std::vector<double> tour_lengths = solver.bid_columns.tour_lengths;
+			for (size_t column = 0; column < tour_lengths.size(); column++) {
+				if (solver.bid_columns.target_ids_2[column] == -1) {
+					double price = (*singleton_prices)[solver.bid_columns.target_ids_1[column]];
+					solver.bid_columns.tour_lengths[column] = std::min(tour_lengths[column], price);
+				}
+			}
+			solve_bid_columns(solver, std::chrono::steady_clock::now(), bound_solution);
+			solver.bid_columns.tour_lengths.swap(tour_lengths);
+			*bound = bound_solution.bound;
+		}
+		stopped_at_deadline = solution.stopped_at_deadline || bound_solution.stopped_at_deadline;
+	} catch (GRBException e) {
+		solver_log(solver, "Error code = %d\n%s\n", e.getErrorCode(), e.getMessage().c_str());
+		return -1;
+	}
+
+	tours.clear();
+	for (size_t local_vehicle_id = 0; local_vehicle_id < vehicle_ids.size(); local_vehicle_id++) {
+		for (int column : solution.vehicle_tours[local_vehicle_id]) {
+			DecomposedTour tour = {vehicle_ids[local_vehicle_id], solver.bid_columns.tour_lengths[column], 0, {-1, -1, -1}, false};
+			int local_target_ids[3];
+			tour.num_targets = column_targets(solver.bid_columns, column, local_target_ids);
+			for (int i = 0; i < tour.num_targets; i++) {
+				tour.target_ids[i] = target_ids[local_target_ids[i]];
+			}
+			tours.push_back(tour);
+		}
+	}
+	return solution.objective;
+}
+
+/*
+ * Solve the instance of a solver by spatial decomposition and repair, and report the tour sum against a lower bound
+ * @param solver - CVRP solver holding the instance (its Gurobi parameters are copied to the region workers)
+ * @param output_file_name - Name of file to output results to (empty for none)
+ * @param encoding - Encoding of the results file
+ * @param instance_name - Name of current problem instance
+ * @param stats - If not NULL, receives the decomposition statistics
+ * Return the minimum sum of tour lengths found (-1 if a region could not be solved)
+ */
+double decomposed_cvrp(CvrpSolver& solver, std::string output_file_name, ResultEncoding encoding = RESULT_ENCODING_TEXT,
+					   std::string instance_name = "CVRP Instance", DecompositionStats* stats = NULL) {
+	auto total_start = std::chrono::steady_clock::now();
+	const Instance& instance = solver.instance;
+	int num_targets = target_count(instance);
+	DecompositionStats decomposition_stats = {};
+	if (num_targets == 0 || vehicle_count(instance) == 0) {
+		solver_log(solver, "Decomposition: the instance has no targets or no vehicles\n");
+		return -1;
+	}
+
+	std::vector<int> order;
+	std::vector<BisectionNode> nodes;
+	bisect_targets(instance, decomposition_max_region_targets, order, nodes);
+	std::vector<int> regions;
+	for (int node_index = 0; node_index < (int) nodes.size(); node_index++) {
+		if (nodes[node_index].middle == nodes[node_index].end) {
+			regions.push_back(node_index);
+		}
+	}
+	decomposition_stats.regions = regions.size();
+
+	// Region workers (single-threaded solves when there are several)
+	int num_workers = decomposition_threads > 0 ? decomposition_threads : std::max(1, (int) std::thread::hardware_concurrency());
+	num_workers = std::max(1, std::min(num_workers, (int) regions.size()));
+	std::vector<CvrpSolver> solvers(num_workers);
+	for (CvrpSolver& worker_solver : solvers) {
+		worker_solver.session.parameters = solver.session.parameters;
+		worker_solver.batch_deadline = solver.batch_deadline;
+		worker_solver.buffer_log = true;
+		if (num_workers > 1) {
+			worker_solver.bid_generation_threads = 1;
+			if (worker_solver.session.parameters.threads == 0) {
+				worker_solver.session.parameters.threads = 1;
+			}
+		}
+	}
+
+	// Nearest feasible depot of each target and the target grid (for the border width and the lower bound)
+	CapacityBuckets buckets;
+	build_capacity_buckets(instance.vehicle_capacity, buckets);
+	std::vector<std::pair<int, int>> slot_depot_locations(vehicle_count(instance));
+	for (int slot = 0; slot < vehicle_count(instance); slot++) {
+		slot_depot_locations[slot] = vehicle_location(instance, buckets.vehicle_order[slot]);
+	}
+	SpatialGrid depot_grid;
+	build_spatial_grid(depot_grid, slot_depot_locations);
+	std::vector<std::pair<int, int>> target_locations;
+	gather_target_locations(instance, target_locations);
+	SpatialGrid target_grid;
+	build_spatial_grid(target_grid, target_locations);
+	std::vector<int> target_regions(num_targets);
+	for (size_t region = 0; region < regions.size(); region++) {
+		for (int i = nodes[regions[region]].begin; i < nodes[regions[region]].end; i++) {
+			target_regions[order[i]] = region;
+		}
+	}
+
+	// Nearest feasible depot distances (-1 for targets no vehicle can carry)
+	std::vector<double> depot_distances(num_targets, -1);
+	std::vector<int> nearest;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		int num_feasible_vehicles = feasible_vehicle_count(buckets, instance.target_weight[target_id]);
+		if (num_feasible_vehicles > 0) {
+			depot_distances[target_id] = sqrt((double) grid_nearest_ties(depot_grid, target_locations[target_id], num_feasible_vehicles, nearest));
+		}
+	}
+
+	// Solve the regions, each with its bound solve
+	auto region_start = std::chrono::steady_clock::now();
+	bool complete_region_pairs = pair_neighbours_k <= 0 && !use_column_generation;
+	std::vector<std::vector<DecomposedTour>> region_tours(regions.size());
+	std::vector<double> region_objectives(regions.size());
+	std::vector<double> region_bounds(regions.size(), 0);
+	std::vector<char> region_stopped(regions.size(), 0);
+	std::vector<std::string> region_errors(regions.size());	// Worker log of a failed solve
+	decomposition_stats.worker_seconds += run_decomposition_tasks(solvers, regions.size(), [&](CvrpSolver& worker_solver, int region) {
+		const BisectionNode& node = nodes[regions[region]];
+		std::vector<int> target_ids(order.begin() + node.begin, order.begin() + node.end);
+
+		// Bound on half of any pair tour missing from the region's columns, for each target
+		std::vector<double> half_pair_bounds(target_ids.size(), 0);
+		std::vector<int> nearest;
+		for (size_t i = 0; i < target_ids.size(); i++) {
+			int target_id = target_ids[i];
+			double depot_distance = depot_distances[target_id];
+			if (depot_distance < 0) {
+				continue;
+			}
+
+			double half_pair_bound = 2 * depot_distance;	// A singleton tour (no pair at all)
+			int max_partner_weight = buckets.capacities[0] - instance.target_weight[target_id];
+			grid_nearest_k(target_grid, target_locations[target_id], decomposition_bound_neighbours + 1, nearest);
+			double farthest_distance = 0;
+			for (int neighbour_id : nearest) {
+				if (neighbour_id == target_id) {
+					continue;
+				}
+				double distance = euclidean_distance(target_locations[target_id], target_locations[neighbour_id]);
+				farthest_distance = std::max(farthest_distance, distance);
+				if ((target_regions[neighbour_id] != region || !complete_region_pairs) && depot_distances[neighbour_id] >= 0 &&
+					instance.target_weight[neighbour_id] <= max_partner_weight) {
+					double pair_bound = std::max(std::max(depot_distance + distance + depot_distances[neighbour_id], 2 * distance),
+												  2 * std::max(depot_distance, depot_distances[neighbour_id]));
+					half_pair_bound = std::min(half_pair_bound, pair_bound / 2);
+				}
+			}
+			if ((int) nearest.size() > decomposition_bound_neighbours) {
+				half_pair_bound = std::min(half_pair_bound, std::max(farthest_distance + std::max(farthest_distance, depot_distance), 2 * depot_distance) / 2);
+			}
+			half_pair_bounds[i] = half_pair_bound;
+		}
+
+		// Under column generation the region's columns are not all bundles: charge each target its cheapest share (a tour
+		// through t is at least 2 dmin(t) long)
+		bool stopped_at_deadline = false;
+		if (use_column_generation) {
+			region_objectives[region] = solve_target_subset(worker_solver, instance, buckets, target_ids, region_tours[region], stopped_at_deadline,
+															NULL, NULL);
+			for (size_t i = 0; i < target_ids.size(); i++) {
+				double depot_distance = std::max(0.0, depot_distances[target_ids[i]]);
+				region_bounds[region] += max_bundle_size >= 3 ? std::min(half_pair_bounds[i], 2 * depot_distance / max_bundle_size) : half_pair_bounds[i];
+			}
+		} else {
+			region_objectives[region] = solve_target_subset(worker_solver, instance, buckets, target_ids, region_tours[region], stopped_at_deadline,
+															&half_pair_bounds, &region_bounds[region]);
+		}
+		region_stopped[region] = stopped_at_deadline;
+		if (region_objectives[region] < 0) {
+			region_errors[region].swap(worker_solver.log);
+		}
+		worker_solver.log.clear();
+	});
+
+	std::vector<DecomposedTour> tours;
+	std::vector<int> target_tours(num_targets, -1);
+	for (size_t region = 0; region < regions.size(); region++) {
+		if (region_objectives[region] < 0) {
+			for (CvrpSolver& worker_solver : solvers) {
+				close_solver_session(worker_solver.session);
+			}
+			solver_log(solver, "Decomposition: region %d could not be solved\n%s", (int) region, region_errors[region].c_str());
+			return -1;
+		}
+		decomposition_stats.stopped_at_deadline = decomposition_stats.stopped_at_deadline || region_stopped[region];
+		decomposition_stats.region_objective += region_objectives[region];
+		decomposition_stats.bound += region_bounds[region];
+		for (const DecomposedTour& tour : region_tours[region]) {
+			for (int i = 0; i < tour.num_targets; i++) {
+				target_tours[tour.target_ids[i]] = tours.size();
+			}
+			tours.push_back(tour);
+		}
+	}
+	decomposition_stats.region_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - region_start).count();
+
+	// Repair: re-solve the tours near each split line, deepest splits first (windows of one depth are disjoint)
+	auto repair_start = std::chrono::steady_clock::now();
+	double border_width = decomposition_border_width;
+	if (border_width <= 0) {
+		int num_coverable = 0;
+		for (double depot_distance : depot_distances) {
+			if (depot_distance >= 0) {
+				border_width += depot_distance;
+				num_coverable++;
+			}
+		}
+		border_width = num_coverable > 0 ? border_width / num_coverable : 0;
+	}
+
+	int max_depth = 0;
+	for (const BisectionNode& node : nodes) {
+		max_depth = std::max(max_depth, node.depth);
+	}
+	for (int depth = max_depth; decomposition_repair && depth >= 0; depth--) {
+		// Windows: the live tours touching each split band, in order along the split line
+		std::vector<std::vector<int>> windows;
+		std::vector<char> in_band(tours.size(), 0);
+		for (const BisectionNode& node : nodes) {
+			if (node.depth != depth || node.middle == node.end) {
+				continue;
+			}
+
+			std::vector<std::pair<int, int>> band_tours;	// (coordinate along the line, tour)
+			for (int i = node.begin; i < node.end; i++) {
+				int target_id = order[i];
+				int tour = target_tours[target_id];
+				if (tour != -1 && !in_band[tour] && std::abs(target_coordinate(instance, target_id, node.axis) - node.split) <= border_width) {
+					in_band[tour] = 1;
+					band_tours.push_back(std::make_pair(target_coordinate(instance, target_id, 1 - node.axis), tour));
+				}
+			}
+			std::sort(band_tours.begin(), band_tours.end());
+
+			int window_targets = decomposition_max_region_targets;	// Start a new window at the first tour
+			for (const std::pair<int, int>& band_tour : band_tours) {
+				int num_tour_targets = tours[band_tour.second].num_targets;
+				if (window_targets + num_tour_targets > decomposition_max_region_targets) {
+					windows.push_back(std::vector<int>());
+					window_targets = 0;
+				}
+				windows.back().push_back(band_tour.second);
+				window_targets += num_tour_targets;
+			}
+		}
+
+		// Re-solve the windows holding several tours
+		std::vector<std::vector<DecomposedTour>> window_tours(windows.size());
+		std::vector<double> window_objectives(windows.size(), -1);
+		std::vector<char> window_stopped(windows.size(), 0);
+		std::vector<std::string> window_errors(windows.size());
+		decomposition_stats.worker_seconds += run_decomposition_tasks(solvers, windows.size(), [&](CvrpSolver& worker_solver, int window) {
+			if (windows[window].size() < 2) {
+				return;
+			}
+			std::vector<int> target_ids;
+			for (int tour : windows[window]) {
+				target_ids.insert(target_ids.end(), tours[tour].target_ids, tours[tour].target_ids + tours[tour].num_targets);
+			}
+			bool stopped_at_deadline = false;
+			window_objectives[window] = solve_target_subset(worker_solver, instance, buckets, target_ids, window_tours[window], stopped_at_deadline,
+															NULL, NULL);
+			window_stopped[window] = stopped_at_deadline;
+			if (window_objectives[window] < 0) {
+				window_errors[window].swap(worker_solver.log);
+			}
+			worker_solver.log.clear();
+		});
+
+		// Keep the shorter tours of each window
+		for (size_t window = 0; window < windows.size(); window++) {
+			if (!window_errors[window].empty()) {
+				solver_log(solver, "Decomposition: repair window %d could not be solved (its tours are kept)\n%s", (int) window,
+						   window_errors[window].c_str());
+			}
+			if (window_objectives[window] < 0) {
+				continue;
+			}
+			decomposition_stats.repair_windows++;
+			decomposition_stats.stopped_at_deadline = decomposition_stats.stopped_at_deadline || window_stopped[window];
+			double old_objective = 0;
+			for (int tour : windows[window]) {
+				old_objective += tours[tour].tour_length;
+			}
+			if (window_objectives[window] >= old_objective - 1e-9 * std::max(1.0, old_objective)) {
+				continue;
+			}
+
+			decomposition_stats.improved_windows++;
+			for (int tour : windows[window]) {
+				tours[tour].replaced = true;
+			}
+			for (const DecomposedTour& tour : window_tours[window]) {
+				for (int i = 0; i < tour.num_targets; i++) {
+					target_tours[tour.target_ids[i]] = tours.size();
+				}
+				tours.push_back(tour);
+			}
+		}
+	}
+	decomposition_stats.repair_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - repair_start).count();
+
+	for (CvrpSolver& worker_solver : solvers) {
+		close_solver_session(worker_solver.session);
+	}
+
+	// Result: tours by vehicle (descending vehicle ID, as results are written), uncoverable targets and the bound
+	ResultRecord record;
+	record.instance_name = instance_name;
+	record.objective = 0;
+	gather_target_locations(instance, record.target_locations);
+	record.vehicle_locations.resize(vehicle_count(instance));
+	record.vehicle_tours.assign(vehicle_count(instance), std::vector<std::vector<int>>());
+	for (const DecomposedTour& tour : tours) {
+		if (!tour.replaced) {
+			record.objective += tour.tour_length;
+			record.vehicle_tours[tour.vehicle_id].push_back(std::vector<int>(tour.target_ids, tour.target_ids + tour.num_targets));
+		}
+	}
+	for (int vehicle_id = vehicle_count(instance) - 1; vehicle_id >= 0; vehicle_id--) {
+		record.vehicle_locations[vehicle_id] = vehicle_location(instance, vehicle_id);
+		record.vehicle_order.push_back(vehicle_id);
+	}
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (target_tours[target_id] == -1) {
+			record.uncovered_targets.push_back(target_id);
+		}
+	}
+	record.bound = std::min(decomposition_stats.bound, record.objective);
+	record.stopped_at_deadline = decomposition_stats.stopped_at_deadline;
+
+	decomposition_stats.objective = record.objective;
+	decomposition_stats.bound = record.bound;
+	decomposition_stats.total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - total_start).count();
+	record.solve_seconds = decomposition_stats.total_seconds;
+
+	solver_log(solver, "Decomposition: %d targets in %d regions (%d workers), region tours %f, repaired %f (%d of %d windows improved), "
+			   "lower bound %f, gap %.2f%%; regions %.3f s, repair %.3f s, CPU %.3f s (parallelism %.2f), total %.3f s\n",
+			   num_targets, decomposition_stats.regions, num_workers, decomposition_stats.region_objective, decomposition_stats.objective,
+			   decomposition_stats.improved_windows, decomposition_stats.repair_windows, decomposition_stats.bound, 100 * result_gap(record),
+			   decomposition_stats.region_seconds, decomposition_stats.repair_seconds, decomposition_stats.worker_seconds,
+			   decomposition_stats.worker_seconds / std::max(1e-9, decomposition_stats.region_seconds + decomposition_stats.repair_seconds),
+			   decomposition_stats.total_seconds);
+
+	if (!output_file_name.empty()) {
+		std::string results;
+		encode_result(record, encoding, results);
+		append_results_to_file(output_file_name, encoding, results);
+	}
+	if (stats != NULL) {
+		*stats = decomposition_stats;
+	}
+
+	return record.objective;
+}
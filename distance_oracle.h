@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+/*
+ * Distance oracle for integer coordinates
+ * Every distance between two points of a bounding box is sqrt(dx^2 + dy^2) for one of its (|dx|, |dy|) offsets, so
+ * when the box is small (the data sets use a 200 x 300 grid) the distances are read from a precomputed offset table
+ * instead of calling sqrt. The table holds the same doubles sqrt returns, so results do not change. It is kept
+ * across instances and only rebuilt when an instance spans a larger box; offsets outside the table (large grids, or
+ * every offset while tables are disabled) fall back to computing the square root.
+ * Nearest-point selection compares squared integer distances and needs no square root at all.
+ */
+
+struct DistanceOracle {
+	int					max_dx = -1;		// Largest tabulated |dx| (-1 = no table)
+	int					max_dy = -1;		// Largest tabulated |dy|
+	std::vector<double>	table;				// Distance of offset (dx, dy) at dx * (max_dy + 1) + dy
+};
+
+// Largest offset table built, in entries of 8 bytes (0 = always compute; 1 << 20 covers e.g. a 1023 x 1023 grid).
+// Off by default: on current x86 cores a table read is slower than a hardware square root, and the lookups keep the
+// distance table build from vectorizing (see benchmarks/distance_oracle_benchmark.cpp).
+long long distance_oracle_max_entries = 0;
+
+/*
+ * Return the distance of an integer offset, computed
+ * @param dx, dy - Offset
+ */
+double computed_offset_distance(int dx, int dy) {
+	return sqrt(dx * dx + dy * dy);
+}
+
+/*
+ * Make the oracle's table cover every offset of a bounding box (the table only grows; boxes too large for it are left
+ * to the computed fallback)
+ * @param oracle - Distance oracle
+ * @param min_x, min_y, max_x, max_y - Bounding box of the points whose distances will be queried
+ */
+void cover_bounding_box(DistanceOracle& oracle, int min_x, int min_y, int max_x, int max_y) {
+	long long box_dx = (long long) max_x - min_x;
+	long long box_dy = (long long) max_y - min_y;
+	if (box_dx <= oracle.max_dx && box_dy <= oracle.max_dy) {
+		return;
+	}
+
+	long long max_dx = std::max<long long>(box_dx, oracle.max_dx);
+	long long max_dy = std::max<long long>(box_dy, oracle.max_dy);
+	if ((max_dx + 1) * (max_dy + 1) > distance_oracle_max_entries) {
+		return;
+	}
+
+	oracle.max_dx = max_dx;
+	oracle.max_dy = max_dy;
+	oracle.table.resize((max_dx + 1) * (max_dy + 1));
+	for (int dx = 0; dx <= max_dx; dx++) {
+		double* row = &oracle.table[(size_t) dx * (max_dy + 1)];
+		for (int dy = 0; dy <= max_dy; dy++) {
+			row[dy] = computed_offset_distance(dx, dy);
+		}
+	}
+}
+
+/*
+ * Make the oracle's table cover the bounding box of two sets of points
+ * @param oracle - Distance oracle
+ * @param locations_1, locations_2 - Points whose distances will be queried (e.g. targets and depots)
+ */
+void cover_locations(DistanceOracle& oracle, const std::vector<std::pair<int, int>>& locations_1, const std::vector<std::pair<int, int>>& locations_2) {
+	bool empty = true;
+	int min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+	for (const std::vector<std::pair<int, int>>* locations : {&locations_1, &locations_2}) {
+		for (const std::pair<int, int>& location : *locations) {
+			if (empty || location.first < min_x) min_x = location.first;
+			if (empty || location.first > max_x) max_x = location.first;
+			if (empty || location.second < min_y) min_y = location.second;
+			if (empty || location.second > max_y) max_y = location.second;
+			empty = false;
+		}
+	}
+
+	if (!empty) {
+		cover_bounding_box(oracle, min_x, min_y, max_x, max_y);
+	}
+}
+
+/*
+ * Return the Euclidean distance between two points, from the offset table when it covers their offset
+ * @param oracle - Distance oracle
+ * @param location1, location2 - The coordinate pairs to measure the distance between
+ */
+double oracle_distance(const DistanceOracle& oracle, std::pair<int, int> location1, std::pair<int, int> location2) {
+	int dx = abs(location1.first - location2.first);
+	int dy = abs(location1.second - location2.second);
+	if (dx <= oracle.max_dx && dy <= oracle.max_dy) {
+		return oracle.table[(size_t) dx * (oracle.max_dy + 1) + dy];
+	}
+
+	return computed_offset_distance(dx, dy);
+}
+
+/*
+ * Return the index of the point nearest to a location (the first one on ties), comparing squared integer distances
+ * @param location - Query location
+ * @param xs, ys - Point coordinates
+ * @param num_points - Number of points (at least one)
+ */
+int nearest_point_index(std::pair<int, int> location, const int* xs, const int* ys, int num_points) {
+	int nearest = 0;
+	long long nearest_squared_distance = -1;
+	for (int i = 0; i < num_points; i++) {
+		long long dx = xs[i] - location.first;
+		long long dy = ys[i] - location.second;
+		long long squared_distance = dx * dx + dy * dy;
+		if (nearest_squared_distance < 0 || squared_distance < nearest_squared_distance) {
+			nearest = i;
+			nearest_squared_distance = squared_distance;
+		}
+	}
+
+	return nearest;
+}
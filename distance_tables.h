@@ -0,0 +1,119 @@
+#pragma once
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "distance_oracle.h"
+
+/*
+ * Instance-level distance store, built once per instance and read by all bid generation
+ * target_target - Packed upper triangle (target_1 < target_2) of the target-target distances
+ *                 (left empty when only a sparse set of pairs is needed; distances are then computed on demand)
+ * target_depot - Dense target x depot distances, one contiguous row of num_vehicles entries per target
+ *                (depots in the order given to build_distance_tables, i.e. the caller's vehicle slot order)
+ * target_locations, depot_locations - Coordinates the tables were built from (depots in vehicle slot order)
+ * oracle - Offset distance table the distances are read from (NULL = computed; must cover both sets of coordinates)
+ */
+struct DistanceTables {
+	int num_targets;
+	int num_vehicles;
+	bool has_target_target;
+	std::vector<double> target_target;
+	std::vector<double> target_depot;
+	std::vector<std::pair<int, int>> target_locations;
+	std::vector<std::pair<int, int>> depot_locations;
+	const DistanceOracle* oracle = NULL;
+};
+
+/*
+ * Return Euclidean distance between two points
+ * @param location1, location2 - The coordinate pairs to measure the distance between
+ */
+double euclidean_distance(std::pair<int, int> location1, std::pair<int, int> location2) {
+	int x_dist = location1.first - location2.first;
+	int y_dist = location1.second - location2.second;
+	return sqrt(x_dist * x_dist + y_dist * y_dist);
+}
+
+/*
+ * Return distance between two points of the tables' instance (from the oracle when the tables have one)
+ * @param tables - Distance tables of the current instance
+ * @param location1, location2 - The coordinate pairs to measure the distance between
+ */
+double table_distance(const DistanceTables& tables, std::pair<int, int> location1, std::pair<int, int> location2) {
+	return tables.oracle != NULL ? oracle_distance(*tables.oracle, location1, location2) : euclidean_distance(location1, location2);
+}
+
+/*
+ * Return index of a target pair in the packed upper-triangular target-target table
+ * @param num_targets - Number of targets in the instance
+ * @param target_id_1, target_id_2 - Target IDs, with target_id_1 < target_id_2
+ */
+size_t packed_pair_index(int num_targets, int target_id_1, int target_id_2) {
+	size_t row = target_id_1;
+	return row * (2 * (size_t) num_targets - row - 1) / 2 + (target_id_2 - target_id_1 - 1);
+}
+
+/*
+ * Build distance tables for an instance with dense target and vehicle IDs
+ * @param tables - Distance tables to populate
+ * @param target_locations - Target coordinates, indexed by target ID
+ * @param depot_locations - Vehicle depot coordinates, indexed by vehicle slot
+ * @param with_target_target - Whether to store the O(T^2) target-target table
+ * @param oracle - Offset distance table covering the targets and depots (NULL or without a table = compute every
+ *                 distance); the tables keep a pointer to it for distances computed on demand
+ */
+void build_distance_tables(DistanceTables& tables, const std::vector<std::pair<int, int>>& target_locations, const std::vector<std::pair<int, int>>& depot_locations,
+						   bool with_target_target = true, const DistanceOracle* oracle = NULL) {
+	int num_targets = target_locations.size();
+	int num_vehicles = depot_locations.size();
+	tables.num_targets = num_targets;
+	tables.num_vehicles = num_vehicles;
+	tables.target_locations = target_locations;
+	tables.depot_locations = depot_locations;
+	tables.has_target_target = with_target_target;
+	tables.oracle = oracle != NULL && !oracle->table.empty() ? oracle : NULL;
+
+	// Target-target distances (upper triangle only, row by row)
+	tables.target_target.clear();
+	tables.target_target.reserve(num_targets > 1 && with_target_target ? (size_t) num_targets * (num_targets - 1) / 2 : 0);
+	for (int target_id_1 = 0; with_target_target && target_id_1 < num_targets; target_id_1++) {
+		for (int target_id_2 = target_id_1 + 1; target_id_2 < num_targets; target_id_2++) {
+			tables.target_target.push_back(table_distance(tables, target_locations[target_id_1], target_locations[target_id_2]));
+		}
+	}
+
+	// Target-depot distances
+	tables.target_depot.resize((size_t) num_targets * num_vehicles);
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		double* row = &tables.target_depot[(size_t) target_id * num_vehicles];
+		for (int slot = 0; slot < num_vehicles; slot++) {
+			row[slot] = table_distance(tables, target_locations[target_id], depot_locations[slot]);
+		}
+	}
+}
+
+/*
+ * Return distance between two distinct targets
+ * @param tables - Distance tables of the current instance
+ * @param target_id_1, target_id_2 - Target IDs (in either order)
+ */
+double target_target_distance(const DistanceTables& tables, int target_id_1, int target_id_2) {
+	if (!tables.has_target_target) {
+		return table_distance(tables, tables.target_locations[target_id_1], tables.target_locations[target_id_2]);
+	}
+
+	if (target_id_1 > target_id_2) {
+		std::swap(target_id_1, target_id_2);
+	}
+
+	return tables.target_target[packed_pair_index(tables.num_targets, target_id_1, target_id_2)];
+}
+
+/*
+ * Return pointer to a target's row of depot distances (indexed by vehicle slot)
+ * @param tables - Distance tables of the current instance
+ * @param target_id - Target ID
+ */
+const double* target_depot_row(const DistanceTables& tables, int target_id) {
+	return &tables.target_depot[(size_t) target_id * tables.num_vehicles];
+}
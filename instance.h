@@ -0,0 +1,111 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+/*
+ * Dense structure-of-arrays instance: target and vehicle IDs are their positions 0..n-1 in the arrays
+ * Loops over targets or vehicles walk contiguous coordinate, weight and capacity arrays in ID order; the coordinate
+ * pairs needed by the distance tables and spatial indexes are gathered once per instance.
+ */
+struct Instance {
+	std::vector<int>	target_x;
+	std::vector<int>	target_y;
+	std::vector<int>	target_weight;
+	std::vector<int>	vehicle_x;			// Depot coordinates
+	std::vector<int>	vehicle_y;
+	std::vector<int>	vehicle_capacity;
+};
+
+/*
+ * Return the number of targets of an instance
+ */
+int target_count(const Instance& instance) {
+	return instance.target_x.size();
+}
+
+/*
+ * Return the number of vehicles of an instance
+ */
+int vehicle_count(const Instance& instance) {
+	return instance.vehicle_x.size();
+}
+
+/*
+ * Return the location of a target
+ * @param instance - Instance
+ * @param target_id - Target ID
+ */
+std::pair<int, int> target_location(const Instance& instance, int target_id) {
+	return std::make_pair(instance.target_x[target_id], instance.target_y[target_id]);
+}
+
+/*
+ * Return the depot location of a vehicle
+ * @param instance - Instance
+ * @param vehicle_id - Vehicle ID
+ */
+std::pair<int, int> vehicle_location(const Instance& instance, int vehicle_id) {
+	return std::make_pair(instance.vehicle_x[vehicle_id], instance.vehicle_y[vehicle_id]);
+}
+
+/*
+ * Add a target to an instance
+ * @param instance - Instance
+ * @param location - Target location
+ * @param weight - Target weight
+ * Return the ID of the new target
+ */
+int add_target(Instance& instance, std::pair<int, int> location, int weight) {
+	instance.target_x.push_back(location.first);
+	instance.target_y.push_back(location.second);
+	instance.target_weight.push_back(weight);
+	return instance.target_x.size() - 1;
+}
+
+/*
+ * Add a vehicle to an instance
+ * @param instance - Instance
+ * @param depot_location - Depot location of the vehicle
+ * @param capacity - Vehicle capacity
+ * Return the ID of the new vehicle
+ */
+int add_vehicle(Instance& instance, std::pair<int, int> depot_location, int capacity) {
+	instance.vehicle_x.push_back(depot_location.first);
+	instance.vehicle_y.push_back(depot_location.second);
+	instance.vehicle_capacity.push_back(capacity);
+	return instance.vehicle_x.size() - 1;
+}
+
+/*
+ * Reserve room for the targets and vehicles of an instance
+ * @param instance - Instance
+ * @param num_targets, num_vehicles - Expected numbers of targets and vehicles
+ */
+void reserve_instance(Instance& instance, int num_targets, int num_vehicles) {
+	instance.target_x.reserve(num_targets);
+	instance.target_y.reserve(num_targets);
+	instance.target_weight.reserve(num_targets);
+	instance.vehicle_x.reserve(num_vehicles);
+	instance.vehicle_y.reserve(num_vehicles);
+	instance.vehicle_capacity.reserve(num_vehicles);
+}
+
+/*
+ * Gather the target locations of an instance (indexed by target ID)
+ * @param instance - Instance
+ * @param locations - Output: target locations
+ */
+void gather_target_locations(const Instance& instance, std::vector<std::pair<int, int>>& locations) {
+	locations.resize(target_count(instance));
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		locations[target_id] = target_location(instance, target_id);
+	}
+}
+
+/*
+ * Remove all targets and vehicles of an instance
+ * @param instance - Instance
+ */
+void clear_instance(Instance& instance) {
+	instance = Instance();
+}
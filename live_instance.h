@@ -0,0 +1,830 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "cvrp.h"
+
+/*
+ * Live instances: incremental re-optimization for dispatch
+ * Targets are added, cancelled and reweighted and vehicles move or go off duty while the instance stays loaded. A live
+ * instance keeps the best bid of every singleton and pair bundle (its cheapest enabled vehicle, lowest vehicle ID on
+ * ties), the bid columns derived from them (a pair column only while it is not dominated by its two singletons, as in
+ * prune_dominated_pair_bids) and, with the MIP backend, one persistent Gurobi model with a variable per column and a
+ * cover constraint per coverable target. An update re-prices only the bundles it can change and adds, removes or
+ * re-prices just their variables and cover constraints; the next solve starts from the previous solution (completed
+ * with singletons for the targets it does not cover).
+ * Live instances solve the best-bid formulation, which has the all-bids optimum as well when no vehicle coupling
+ * constraints exist (see generates_best_bids_only); tied vehicles are not spread over tours.
+ */
+
+struct LiveBundle {
+	double	tour_length = 0;	// Tour length of the best bid
+	int		vehicle_id = -1;	// Cheapest enabled vehicle able to carry the bundle (-1 = none)
+	int		column = -1;		// Live column of the bundle (-1 = none)
+};
+
+struct LiveUpdateStats {
+	int		bundles_repriced = 0;		// Bundles whose best bid was recomputed or challenged by a moved vehicle
+	int		columns_added = 0;
+	int		columns_removed = 0;
+	int		columns_changed = 0;		// Columns re-priced in place (new vehicle or tour length)
+	int		constraints_added = 0;
+	int		constraints_removed = 0;
+	double	update_seconds = 0;
+};
+
+struct LiveInstance {
+	CvrpSolver								solver;				// Instance (IDs are never reused), session and the packed columns of the last solve
+	std::vector<char>						target_active;		// Removed targets stay in the instance, inactive
+	std::vector<char>						vehicle_enabled;
+	std::vector<double>						depot_distances;	// Target-depot distances, one row of num_vehicles entries per target
+	std::vector<LiveBundle>					singleton_bids;		// Best singleton bid of each target
+	std::vector<std::vector<LiveBundle>>	pair_bids;			// pair_bids[t2][t1]: best bid of the pair {t1, t2}, t1 < t2
+	std::vector<std::vector<double>>		pair_distances;		// pair_distances[t2][t1]: distance between targets t1 < t2
+	BidColumns								columns;			// Live columns (no cover rows; free columns have target_id_1 == -1)
+	std::vector<int>						free_columns;
+	std::vector<char>						column_selected;	// Columns of the last solution (the next warm start)
+	GRBModel*								model = NULL;		// Persistent cover model (MIP backend)
+	std::vector<GRBVar>						column_vars;		// Variable of each live column (with a model)
+	std::vector<GRBConstr>					cover_constrs;		// Cover constraint of each target (with a model)
+	std::vector<char>						has_cover_constr;
+	std::vector<int>						packed_columns;		// Live column of each column of solver.bid_columns
+	LiveUpdateStats							stats;				// Work of the last update
+	bool									log_updates = true;	// Log the work and latency of every update
+};
+
+/*
+ * Return whether live instances keep a Gurobi model (every backend but the matching one)
+ */
+bool live_uses_model() {
+	return solver_backend != SOLVER_BACKEND_MATCHING;
+}
+
+/*
+ * Return the tour length of a bundle for a vehicle
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ * @param vehicle_id - Vehicle ID
+ */
+double live_tour_length(const LiveInstance& live, int target_id_1, int target_id_2, int vehicle_id) {
+	int num_vehicles = vehicle_count(live.solver.instance);
+	const double* depot_distances_1 = &live.depot_distances[(size_t) target_id_1 * num_vehicles];
+	if (target_id_2 == -1) {
+		return 2.0 * depot_distances_1[vehicle_id];
+	}
+
+	const double* depot_distances_2 = &live.depot_distances[(size_t) target_id_2 * num_vehicles];
+	return live.pair_distances[target_id_2][target_id_1] + depot_distances_1[vehicle_id] + depot_distances_2[vehicle_id];
+}
+
+/*
+ * Return the weight of a bundle
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ */
+int live_bundle_weight(const LiveInstance& live, int target_id_1, int target_id_2) {
+	const std::vector<int>& weights = live.solver.instance.target_weight;
+	return weights[target_id_1] + (target_id_2 != -1 ? weights[target_id_2] : 0);
+}
+
+/*
+ * Offer a bundle to a vehicle: it becomes the bundle's best bid if the vehicle is enabled, can carry the bundle and
+ * is cheaper (or as cheap with a lower ID)
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ * @param vehicle_id - Vehicle ID
+ * @param bundle - Best bid of the bundle
+ */
+void challenge_bundle(const LiveInstance& live, int target_id_1, int target_id_2, int vehicle_id, LiveBundle& bundle) {
+	if (!live.vehicle_enabled[vehicle_id] || live_bundle_weight(live, target_id_1, target_id_2) > live.solver.instance.vehicle_capacity[vehicle_id]) {
+		return;
+	}
+
+	double tour_length = live_tour_length(live, target_id_1, target_id_2, vehicle_id);
+	if (bundle.vehicle_id == -1 || tour_length < bundle.tour_length || (tour_length == bundle.tour_length && vehicle_id < bundle.vehicle_id)) {
+		bundle.tour_length = tour_length;
+		bundle.vehicle_id = vehicle_id;
+	}
+}
+
+/*
+ * Recompute the best bid of a bundle over all vehicles
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ * @param bundle - Best bid of the bundle (its column is kept)
+ */
+void reprice_bundle(LiveInstance& live, int target_id_1, int target_id_2, LiveBundle& bundle) {
+	bundle.vehicle_id = -1;
+	bundle.tour_length = 0;
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(live.solver.instance); vehicle_id++) {
+		challenge_bundle(live, target_id_1, target_id_2, vehicle_id, bundle);
+	}
+	live.stats.bundles_repriced++;
+}
+
+/*
+ * Return whether a bundle should have a column: its targets are active, some vehicle carries it and (pairs, with
+ * dominance pruning) it is cheaper than its two singletons
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ * @param bundle - Best bid of the bundle
+ */
+bool bundle_column_wanted(const LiveInstance& live, int target_id_1, int target_id_2, const LiveBundle& bundle) {
+	if (bundle.vehicle_id == -1 || !live.target_active[target_id_1] || (target_id_2 != -1 && !live.target_active[target_id_2])) {
+		return false;
+	}
+	if (target_id_2 == -1 || !prune_dominated_pairs) {
+		return true;
+	}
+
+	const LiveBundle& singleton_1 = live.singleton_bids[target_id_1];
+	const LiveBundle& singleton_2 = live.singleton_bids[target_id_2];
+	return singleton_1.vehicle_id == -1 || singleton_2.vehicle_id == -1 || bundle.tour_length < singleton_1.tour_length + singleton_2.tour_length;
+}
+
+/*
+ * Add or remove the cover constraint of a target so that exactly the coverable active targets have one
+ * (constraints are added before the target's columns and may be removed before them)
+ * @param live - Live instance
+ * @param target_id - Target ID
+ */
+void sync_cover_constraint(LiveInstance& live, int target_id) {
+	bool wanted = live.target_active[target_id] && live.singleton_bids[target_id].vehicle_id != -1;
+	if (wanted == (bool) live.has_cover_constr[target_id]) {
+		return;
+	}
+
+	// Constraint: target must be serviced exactly once (its columns are added to it as they are created)
+	if (live.model != NULL) {
+		if (wanted) {
+			live.cover_constrs[target_id] = live.model->addConstr(GRBLinExpr(), GRB_EQUAL, 1.0);
+		} else {
+			live.model->remove(live.cover_constrs[target_id]);
+		}
+	}
+
+	live.has_cover_constr[target_id] = wanted;
+	wanted ? live.stats.constraints_added++ : live.stats.constraints_removed++;
+}
+
+/*
+ * Bring the column of a bundle in line with its best bid: add it, remove it or re-price it in place
+ * @param live - Live instance
+ * @param target_id_1, target_id_2 - Targets of the bundle (target_id_2 = -1 for a singleton)
+ * @param bundle - Best bid of the bundle
+ */
+void sync_bundle_column(LiveInstance& live, int target_id_1, int target_id_2, LiveBundle& bundle) {
+	bool wanted = bundle_column_wanted(live, target_id_1, target_id_2, bundle);
+	BidColumns& columns = live.columns;
+
+	if (!wanted) {
+		if (bundle.column != -1) {
+			if (live.model != NULL) {
+				live.model->remove(live.column_vars[bundle.column]);
+			}
+			columns.target_ids_1[bundle.column] = -1;
+			columns.target_ids_2[bundle.column] = -1;
+			live.column_selected[bundle.column] = 0;
+			live.free_columns.push_back(bundle.column);
+			bundle.column = -1;
+			live.stats.columns_removed++;
+		}
+		return;
+	}
+
+	if (bundle.column != -1) {
+		if (columns.vehicle_ids[bundle.column] != bundle.vehicle_id || columns.tour_lengths[bundle.column] != bundle.tour_length) {
+			columns.vehicle_ids[bundle.column] = bundle.vehicle_id;
+			columns.tour_lengths[bundle.column] = bundle.tour_length;
+			if (live.model != NULL) {
+				live.column_vars[bundle.column].set(GRB_DoubleAttr_Obj, bundle.tour_length);
+			}
+			live.stats.columns_changed++;
+		}
+		return;
+	}
+
+	// New column, reusing a free one if any
+	if (!live.free_columns.empty()) {
+		bundle.column = live.free_columns.back();
+		live.free_columns.pop_back();
+	} else {
+		bundle.column = columns.tour_lengths.size();
+		columns.tour_lengths.push_back(0);
+		columns.vehicle_ids.push_back(-1);
+		columns.target_ids_1.push_back(-1);
+		columns.target_ids_2.push_back(-1);
+		columns.target_ids_3.push_back(-1);
+		live.column_selected.push_back(0);
+		if (live.model != NULL) {
+			live.column_vars.push_back(GRBVar());
+		}
+	}
+
+	columns.tour_lengths[bundle.column] = bundle.tour_length;
+	columns.vehicle_ids[bundle.column] = bundle.vehicle_id;
+	columns.target_ids_1[bundle.column] = target_id_1;
+	columns.target_ids_2[bundle.column] = target_id_2;
+	live.column_selected[bundle.column] = 0;
+	if (live.model != NULL) {
+		GRBColumn cover_column;
+		cover_column.addTerm(1.0, live.cover_constrs[target_id_1]);
+		if (target_id_2 != -1) {
+			cover_column.addTerm(1.0, live.cover_constrs[target_id_2]);
+		}
+		live.column_vars[bundle.column] = live.model->addVar(0.0, 1.0, bundle.tour_length, GRB_BINARY, cover_column);
+	}
+	live.stats.columns_added++;
+}
+
+/*
+ * Bring the cover constraint and all bundle columns of one target in line with their best bids
+ * @param live - Live instance
+ * @param target_id - Target ID
+ */
+void sync_target_columns(LiveInstance& live, int target_id) {
+	sync_cover_constraint(live, target_id);
+	sync_bundle_column(live, target_id, -1, live.singleton_bids[target_id]);
+	for (int other_id = 0; other_id < target_count(live.solver.instance); other_id++) {
+		if (other_id < target_id) {
+			sync_bundle_column(live, other_id, target_id, live.pair_bids[target_id][other_id]);
+		} else if (other_id > target_id) {
+			sync_bundle_column(live, target_id, other_id, live.pair_bids[other_id][target_id]);
+		}
+	}
+}
+
+/*
+ * Re-price every bundle of one target and update its columns
+ * @param live - Live instance
+ * @param target_id - Target ID
+ */
+void reprice_target(LiveInstance& live, int target_id) {
+	reprice_bundle(live, target_id, -1, live.singleton_bids[target_id]);
+	for (int other_id = 0; other_id < target_count(live.solver.instance); other_id++) {
+		if (!live.target_active[other_id]) {
+			continue;
+		}
+		if (other_id < target_id) {
+			reprice_bundle(live, other_id, target_id, live.pair_bids[target_id][other_id]);
+		} else if (other_id > target_id) {
+			reprice_bundle(live, target_id, other_id, live.pair_bids[other_id][target_id]);
+		}
+	}
+
+	sync_target_columns(live, target_id);
+}
+
+/*
+ * Update every bundle after a vehicle moved or was enabled or disabled: bundles it served are re-priced over all
+ * vehicles, the others only challenged by the vehicle
+ * @param live - Live instance
+ * @param vehicle_id - Vehicle ID
+ */
+void reprice_vehicle(LiveInstance& live, int vehicle_id) {
+	int num_targets = target_count(live.solver.instance);
+	auto update_bundle = [&](int target_id_1, int target_id_2, LiveBundle& bundle) {
+		LiveBundle previous = bundle;
+		if (bundle.vehicle_id == vehicle_id) {
+			reprice_bundle(live, target_id_1, target_id_2, bundle);
+		} else {
+			challenge_bundle(live, target_id_1, target_id_2, vehicle_id, bundle);
+			live.stats.bundles_repriced++;
+		}
+		return bundle.vehicle_id != previous.vehicle_id || bundle.tour_length != previous.tour_length;
+	};
+
+	// Singletons and their columns first (pair dominance depends on them)
+	std::vector<char> singleton_changed(num_targets, 0);
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (live.target_active[target_id]) {
+			singleton_changed[target_id] = update_bundle(target_id, -1, live.singleton_bids[target_id]);
+			sync_cover_constraint(live, target_id);
+			sync_bundle_column(live, target_id, -1, live.singleton_bids[target_id]);
+		}
+	}
+
+	// Pairs whose best bid or singletons changed
+	for (int target_id_2 = 0; target_id_2 < num_targets; target_id_2++) {
+		if (!live.target_active[target_id_2]) {
+			continue;
+		}
+		std::vector<LiveBundle>& pair_row = live.pair_bids[target_id_2];
+		for (int target_id_1 = 0; target_id_1 < target_id_2; target_id_1++) {
+			if (live.target_active[target_id_1] && (update_bundle(target_id_1, target_id_2, pair_row[target_id_1])
+													 || singleton_changed[target_id_1] || singleton_changed[target_id_2])) {
+				sync_bundle_column(live, target_id_1, target_id_2, pair_row[target_id_1]);
+			}
+		}
+	}
+}
+
+/*
+ * Append the distance rows and empty best bids of the next target (rows exist for all lower target IDs)
+ * @param live - Live instance
+ * @param target_id - Target ID (the number of targets with rows so far)
+ */
+void add_target_rows(LiveInstance& live, int target_id) {
+	const Instance& instance = live.solver.instance;
+	std::pair<int, int> location = target_location(instance, target_id);
+
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+		live.depot_distances.push_back(euclidean_distance(location, vehicle_location(instance, vehicle_id)));
+	}
+
+	live.pair_distances.push_back(std::vector<double>(target_id));
+	for (int other_id = 0; other_id < target_id; other_id++) {
+		live.pair_distances[target_id][other_id] = euclidean_distance(target_location(instance, other_id), location);
+	}
+
+	live.target_active.push_back(1);
+	live.singleton_bids.push_back(LiveBundle());
+	live.pair_bids.push_back(std::vector<LiveBundle>(target_id));
+	live.has_cover_constr.push_back(0);
+	if (live.model != NULL) {
+		live.cover_constrs.push_back(GRBConstr());
+	}
+}
+
+/*
+ * Log the work and latency of the last update of a live instance
+ * @param live - Live instance
+ * @param description - Update description
+ */
+void log_live_update(LiveInstance& live, const char* description) {
+	const LiveUpdateStats& stats = live.stats;
+	if (!live.log_updates) {
+		return;
+	}
+	solver_log(live.solver, "Live update (%s): %d bundles re-priced, columns +%d -%d ~%d, constraints +%d -%d, %.3f ms\n", description,
+			   stats.bundles_repriced, stats.columns_added, stats.columns_removed, stats.columns_changed,
+			   stats.constraints_added, stats.constraints_removed, 1000 * stats.update_seconds);
+}
+
+/*
+ * Start a live instance from the instance generated into its solver (e.g. by generate_instance): price every bundle
+ * and build the columns and, with the MIP backend, the cover model
+ * @param live - Live instance whose solver holds the instance (vehicles are enabled unless flags are already set)
+ */
+void start_live_instance(LiveInstance& live) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+	if ((int) live.vehicle_enabled.size() != vehicle_count(live.solver.instance)) {
+		live.vehicle_enabled.assign(vehicle_count(live.solver.instance), 1);
+	}
+	if (live_uses_model() && live.model == NULL) {
+		live.model = new GRBModel(session_environment(live.solver.session));
+		live.model->set(GRB_StringAttr_ModelName, "live_cvrp");
+		live.solver.session.stats.models_created++;
+	}
+
+	// Distance rows and best bids of every target (pairs of each target with the earlier ones)
+	const Instance& instance = live.solver.instance;
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		add_target_rows(live, target_id);
+		reprice_bundle(live, target_id, -1, live.singleton_bids[target_id]);
+		for (int other_id = 0; other_id < target_id; other_id++) {
+			reprice_bundle(live, other_id, target_id, live.pair_bids[target_id][other_id]);
+		}
+	}
+
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		sync_cover_constraint(live, target_id);
+		sync_bundle_column(live, target_id, -1, live.singleton_bids[target_id]);
+	}
+	for (int target_id_2 = 0; target_id_2 < target_count(instance); target_id_2++) {
+		for (int target_id_1 = 0; target_id_1 < target_id_2; target_id_1++) {
+			sync_bundle_column(live, target_id_1, target_id_2, live.pair_bids[target_id_2][target_id_1]);
+		}
+	}
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, "start");
+}
+
+/*
+ * Add a target to a live instance
+ * @param live - Live instance
+ * @param location - Target location
+ * @param weight - Target weight
+ * Return the ID of the new target
+ */
+int live_add_target(LiveInstance& live, std::pair<int, int> location, int weight) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+
+	int target_id = add_target(live.solver.instance, location, weight);
+	add_target_rows(live, target_id);
+	reprice_target(live, target_id);
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, "add target");
+	return target_id;
+}
+
+/*
+ * Remove (cancel) a target of a live instance; its ID is not reused
+ * @param live - Live instance
+ * @param target_id - Active target ID
+ */
+void live_remove_target(LiveInstance& live, int target_id) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+
+	live.target_active[target_id] = 0;
+	sync_target_columns(live, target_id);
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, "remove target");
+}
+
+/*
+ * Change the weight of a target of a live instance
+ * @param live - Live instance
+ * @param target_id - Active target ID
+ * @param weight - New target weight
+ */
+void live_set_target_weight(LiveInstance& live, int target_id, int weight) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+
+	live.solver.instance.target_weight[target_id] = weight;
+	reprice_target(live, target_id);
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, "set weight");
+}
+
+/*
+ * Move the depot (current position) of a vehicle of a live instance
+ * @param live - Live instance
+ * @param vehicle_id - Vehicle ID
+ * @param location - New depot location
+ */
+void live_move_vehicle(LiveInstance& live, int vehicle_id, std::pair<int, int> location) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+
+	Instance& instance = live.solver.instance;
+	instance.vehicle_x[vehicle_id] = location.first;
+	instance.vehicle_y[vehicle_id] = location.second;
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		live.depot_distances[(size_t) target_id * vehicle_count(instance) + vehicle_id] = euclidean_distance(target_location(instance, target_id), location);
+	}
+	reprice_vehicle(live, vehicle_id);
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, "move vehicle");
+}
+
+/*
+ * Enable or disable a vehicle of a live instance (a disabled vehicle gets no tours)
+ * @param live - Live instance
+ * @param vehicle_id - Vehicle ID
+ * @param enabled - Whether the vehicle can be assigned tours
+ */
+void live_set_vehicle_enabled(LiveInstance& live, int vehicle_id, bool enabled) {
+	auto update_start = std::chrono::steady_clock::now();
+	live.stats = LiveUpdateStats();
+
+	if (live.vehicle_enabled[vehicle_id] != enabled) {
+		live.vehicle_enabled[vehicle_id] = enabled;
+		reprice_vehicle(live, vehicle_id);
+	}
+
+	live.stats.update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+	log_live_update(live, enabled ? "enable vehicle" : "disable vehicle");
+}
+
+/*
+ * Solve the current state of a live instance, starting from the previous solution
+ * The live columns are packed into the solver's bid columns, so the solution can be printed and recorded like one of
+ * cvrp() (removed targets and disabled vehicles simply have no tours).
+ * @param live - Live instance
+ * @param solution - Output: solution (columns index the solver's bid columns)
+ * Return the minimum sum of tour lengths
+ */
+double live_solve(LiveInstance& live, CvrpSolution& solution) {
+	CvrpSolver& solver = live.solver;
+	int num_targets = target_count(solver.instance);
+	int num_vehicles = vehicle_count(solver.instance);
+	solver.deadline = earlier_deadline(deadline_after(instance_time_limit), solver.batch_deadline);
+
+	// Pack the live columns (and their variables) and the warm start
+	BidColumns& packed = solver.bid_columns;
+	packed = BidColumns();
+	live.packed_columns.clear();
+	solver.bid_vars.clear();
+	std::vector<char> start_columns;
+	std::vector<char> started(num_targets, 0);
+	for (int column = 0; column < (int) live.columns.tour_lengths.size(); column++) {
+		int target_id_1 = live.columns.target_ids_1[column];
+		int target_id_2 = live.columns.target_ids_2[column];
+		if (target_id_1 == -1) {
+			continue;
+		}
+
+		live.packed_columns.push_back(column);
+		packed.tour_lengths.push_back(live.columns.tour_lengths[column]);
+		packed.vehicle_ids.push_back(live.columns.vehicle_ids[column]);
+		packed.target_ids_1.push_back(target_id_1);
+		packed.target_ids_2.push_back(target_id_2);
+		packed.target_ids_3.push_back(-1);
+		if (live.model != NULL) {
+			solver.bid_vars.push_back(live.column_vars[column]);
+		}
+		start_columns.push_back(live.column_selected[column]);
+		if (live.column_selected[column]) {
+			started[target_id_1] = 1;
+			if (target_id_2 != -1) {
+				started[target_id_2] = 1;
+			}
+		}
+	}
+	build_cover_rows(packed, num_targets);
+	solver.bid_ties = TiedVehicles();
+
+	// Targets the previous solution does not cover start on their singleton; uncoverable active targets are reported
+	std::vector<int> uncovered_targets;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (!live.target_active[target_id]) {
+			continue;
+		}
+		const LiveBundle& singleton = live.singleton_bids[target_id];
+		if (singleton.column == -1) {
+			uncovered_targets.push_back(target_id);
+		} else if (!started[target_id]) {
+			int packed_column = std::lower_bound(live.packed_columns.begin(), live.packed_columns.end(), singleton.column) - live.packed_columns.begin();
+			start_columns[packed_column] = 1;
+		}
+	}
+
+	if (live.model != NULL) {
+		GRBModel& model = *live.model;
+		model.update();
+		set_mip_start(model, solver.bid_vars, start_columns);
+
+		bool optimized = seconds_remaining(solver.deadline) > 0;
+		if (optimized) {
+			set_model_deadline(solver.session, model, solver.deadline);
+			optimize_in_session(solver.session, model);
+		}
+
+		if (optimized && model.get(GRB_IntAttr_SolCount) > 0) {
+			decode_solution(model, packed, solver.bid_vars, num_vehicles, solution);
+		} else {
+			decode_selected_columns(packed, start_columns, num_vehicles, solution);
+			solution.bound = column_share_bound(packed);
+			solution.stopped_at_deadline = true;
+		}
+		if (solution.stopped_at_deadline) {
+			solver.deadline_stops++;
+		}
+	}
+
+	if (solver_backend != SOLVER_BACKEND_MIP) {
+		CvrpSolution matching_solution;
+		MatchingStats matching_stats;
+		solve_cover_by_matching(packed, num_targets, num_vehicles, matching_solution, matching_stats);
+		if (live.model == NULL) {
+			solution = matching_solution;
+		} else if (std::fabs(solution.objective - matching_solution.objective) > 1e-4 * std::max(1.0, std::fabs(matching_solution.objective))) {
+			solver_log(solver, "Cross-check mismatch: MIP %f, matching %f\n", solution.objective, matching_solution.objective);
+		}
+	}
+	solution.uncovered_targets = uncovered_targets;
+
+	// The accepted columns are the next warm start
+	std::fill(live.column_selected.begin(), live.column_selected.end(), 0);
+	for (int column : solution.accepted_columns) {
+		live.column_selected[live.packed_columns[column]] = 1;
+	}
+
+	return solution.objective;
+}
+
+/*
+ * Solve the current state of a live instance from scratch with cvrp() (for reference): the active targets and enabled
+ * vehicles are copied into another solver, renumbered densely
+ * @param live - Live instance
+ * @param rebuild_solver - Solver to rebuild the instance in (its session is reused across rebuilds)
+ * Return the minimum sum of tour lengths (-1 if the instance could not be solved)
+ */
+double live_rebuild_objective(LiveInstance& live, CvrpSolver& rebuild_solver) {
+	const Instance& instance = live.solver.instance;
+	reset_state(rebuild_solver);
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		if (live.target_active[target_id]) {
+			add_target(rebuild_solver.instance, target_location(instance, target_id), instance.target_weight[target_id]);
+		}
+	}
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+		if (live.vehicle_enabled[vehicle_id]) {
+			add_vehicle(rebuild_solver.instance, vehicle_location(instance, vehicle_id), instance.vehicle_capacity[vehicle_id]);
+		}
+	}
+
+	return cvrp(rebuild_solver, true, "", "Live Rebuild");
+}
+
+/*
+ * Release the model of a live instance and clear its bundles and columns (instance, vehicle flags and session are kept)
+ * @param live - Live instance
+ */
+void clear_live_state(LiveInstance& live) {
+	delete live.model;
+	live.model = NULL;
+	live.target_active.clear();
+	live.depot_distances.clear();
+	live.singleton_bids.clear();
+	live.pair_bids.clear();
+	live.pair_distances.clear();
+	live.columns = BidColumns();
+	live.free_columns.clear();
+	live.column_selected.clear();
+	live.column_vars.clear();
+	live.cover_constrs.clear();
+	live.has_cover_constr.clear();
+	live.packed_columns.clear();
+}
+
+/*
+ * Release the model of a live instance and clear it (the solver session is kept)
+ * @param live - Live instance
+ */
+void close_live_instance(LiveInstance& live) {
+	clear_live_state(live);
+	clear_instance(live.solver.instance);
+	live.vehicle_enabled.clear();
+}
+
+/*
+ * Drop the removed targets of a live instance: the active targets are renumbered densely (in ID order) and the
+ * instance is restarted, keeping vehicle IDs and flags and the previous solution as warm start
+ * Removed targets stay in a live instance until it is compacted, so long-running instances compact periodically.
+ * @param live - Live instance
+ * @param kept_targets - Output: previous ID of each target (indexed by new ID)
+ */
+void compact_live_instance(LiveInstance& live, std::vector<int>& kept_targets) {
+	const Instance& instance = live.solver.instance;
+	std::vector<int> new_ids(target_count(instance), -1);
+	kept_targets.clear();
+	Instance compacted;
+	for (int target_id = 0; target_id < target_count(instance); target_id++) {
+		if (live.target_active[target_id]) {
+			new_ids[target_id] = kept_targets.size();
+			kept_targets.push_back(target_id);
+		}
+	}
+	reserve_instance(compacted, kept_targets.size(), vehicle_count(instance));
+	for (int target_id : kept_targets) {
+		add_target(compacted, target_location(instance, target_id), instance.target_weight[target_id]);
+	}
+	for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+		add_vehicle(compacted, vehicle_location(instance, vehicle_id), instance.vehicle_capacity[vehicle_id]);
+	}
+
+	// Bundles of the previous solution, renumbered
+	std::vector<std::pair<int, int>> selected_bundles;
+	for (int column = 0; column < (int) live.columns.tour_lengths.size(); column++) {
+		int target_id_1 = live.columns.target_ids_1[column];
+		int target_id_2 = live.columns.target_ids_2[column];
+		if (target_id_1 != -1 && live.column_selected[column]) {
+			selected_bundles.push_back(std::make_pair(new_ids[target_id_1], target_id_2 != -1 ? new_ids[target_id_2] : -1));
+		}
+	}
+
+	clear_live_state(live);
+	live.solver.instance = compacted;
+	start_live_instance(live);
+
+	for (const std::pair<int, int>& bundle : selected_bundles) {
+		int column = bundle.second == -1 ? live.singleton_bids[bundle.first].column : live.pair_bids[bundle.second][bundle.first].column;
+		if (column != -1) {
+			live.column_selected[column] = 1;
+		}
+	}
+}
+
+/*
+ * Replay random dispatch updates on every dataset instance and report the latency of each incremental update and
+ * re-solve against a full cvrp() rebuild of the same state (one line per instance, then a summary)
+ * Updates are drawn evenly from: add a target (location within the instance's bounding box, weight of an existing
+ * target), remove a target, reweight a target, move a vehicle, and disable or re-enable a vehicle. The updates come
+ * from a fixed seed so that reports can be reproduced, and one live instance (and solver session) serves all instances.
+ * @param num_updates - Updates per instance
+ * @param input_file_name - Name of input data file
+ * @param report_file_name - Name of file to write the report to
+ */
+void live_update_report(int num_updates, std::string input_file_name, std::string report_file_name) {
+	std::ofstream outfile(report_file_name);
+	CvrpSolver rebuild_solver;
+	rebuild_solver.session.parameters = cvrp_solver.session.parameters;
+	rebuild_solver.buffer_log = true;
+	int num_instances = 0;
+	int num_mismatches = 0;
+	long long total_updates = 0;
+	double total_incremental_seconds = 0;
+	double total_update_seconds = 0;
+	double total_rebuild_seconds = 0;
+	double max_incremental_seconds = 0;
+	LiveInstance live;
+	live.solver.session.parameters = cvrp_solver.session.parameters;
+	live.solver.buffer_log = true;
+	srand(1);
+
+	for_each_dataset_instance(cvrp_solver, input_file_name, [&](std::string dataset_name) {
+		live.solver.instance = cvrp_solver.instance;
+		live.solver.log.clear();
+		const Instance& instance = live.solver.instance;
+		if (target_count(instance) == 0 || vehicle_count(instance) == 0) {
+			return;
+		}
+
+		try {
+			start_live_instance(live);
+			CvrpSolution solution;
+			live_solve(live, solution);
+
+			// Bounding box of the instance for new locations
+			int min_x = instance.target_x[0], max_x = min_x, min_y = instance.target_y[0], max_y = min_y;
+			for (int target_id = 0; target_id < target_count(instance); target_id++) {
+				min_x = std::min(min_x, instance.target_x[target_id]);
+				max_x = std::max(max_x, instance.target_x[target_id]);
+				min_y = std::min(min_y, instance.target_y[target_id]);
+				max_y = std::max(max_y, instance.target_y[target_id]);
+			}
+
+			double incremental_seconds = 0;
+			double model_update_seconds = 0;
+			double rebuild_seconds = 0;
+			int mismatches = 0;
+			for (int update = 0; update < num_updates; update++) {
+				std::vector<int> active_targets;
+				for (int target_id = 0; target_id < target_count(instance); target_id++) {
+					if (live.target_active[target_id]) {
+						active_targets.push_back(target_id);
+					}
+				}
+
+				auto update_start = std::chrono::steady_clock::now();
+				int kind = rand() % 5;
+				if (kind == 0 || active_targets.size() < 2) {
+					std::pair<int, int> location(min_x + rand() % (max_x - min_x + 1), min_y + rand() % (max_y - min_y + 1));
+					live_add_target(live, location, instance.target_weight[rand() % target_count(instance)]);
+				} else if (kind == 1) {
+					live_remove_target(live, active_targets[rand() % active_targets.size()]);
+				} else if (kind == 2) {
+					live_set_target_weight(live, active_targets[rand() % active_targets.size()], instance.target_weight[rand() % target_count(instance)]);
+				} else if (kind == 3) {
+					std::pair<int, int> location(min_x + rand() % (max_x - min_x + 1), min_y + rand() % (max_y - min_y + 1));
+					live_move_vehicle(live, rand() % vehicle_count(instance), location);
+				} else {
+					int vehicle_id = rand() % vehicle_count(instance);
+					live_set_vehicle_enabled(live, vehicle_id, !live.vehicle_enabled[vehicle_id]);
+				}
+				model_update_seconds += live.stats.update_seconds;
+				double objective = live_solve(live, solution);
+				double update_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+
+				auto rebuild_start = std::chrono::steady_clock::now();
+				double rebuild_objective = live_rebuild_objective(live, rebuild_solver);
+				double update_rebuild_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - rebuild_start).count();
+				rebuild_solver.log.clear();
+
+				incremental_seconds += update_seconds;
+				rebuild_seconds += update_rebuild_seconds;
+				max_incremental_seconds = std::max(max_incremental_seconds, update_seconds);
+				mismatches += std::fabs(objective - rebuild_objective) > 1e-4 * std::max(1.0, std::fabs(rebuild_objective));
+			}
+
+			outfile << dataset_name << ": " << num_updates << " updates, incremental " << 1000 * incremental_seconds / num_updates
+					<< " ms/update (" << 1000 * model_update_seconds / num_updates << " ms before the solve), rebuild " << 1000 * rebuild_seconds / num_updates << " ms/update, objective mismatches " << mismatches << "\n";
+			num_instances++;
+			num_mismatches += mismatches;
+			total_updates += num_updates;
+			total_incremental_seconds += incremental_seconds;
+			total_update_seconds += model_update_seconds;
+			total_rebuild_seconds += rebuild_seconds;
+		} catch (GRBException e) {
+			outfile << dataset_name << ": error code " << e.getErrorCode() << ", " << e.getMessage() << "\n";
+		}
+
+		close_live_instance(live);
+	});
+
+	close_solver_session(live.solver.session);
+	close_solver_session(rebuild_solver.session);
+	double mean_incremental_ms = total_updates > 0 ? 1000 * total_incremental_seconds / total_updates : 0;
+	double mean_update_ms = total_updates > 0 ? 1000 * total_update_seconds / total_updates : 0;
+	double mean_rebuild_ms = total_updates > 0 ? 1000 * total_rebuild_seconds / total_updates : 0;
+	outfile << "Instances: " << num_instances << ", updates: " << total_updates << ", incremental: " << mean_incremental_ms
+			<< " ms/update (max " << 1000 * max_incremental_seconds << " ms, " << mean_update_ms << " ms before the solve), rebuild: " << mean_rebuild_ms
+			<< " ms/update, objective mismatches: " << num_mismatches << "\n";
+	printf("Live updates: %d instances, %lld updates, incremental %.3f ms/update (max %.3f ms, %.3f ms before the solve), rebuild %.3f ms/update, %d objective mismatches\n",
+		   num_instances, total_updates, mean_incremental_ms, 1000 * max_incremental_seconds, mean_update_ms, mean_rebuild_ms, num_mismatches);
+}
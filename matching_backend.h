@@ -0,0 +1,191 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "max_weight_matching.h"
+#include "model_builder.h"
+
+/*
+ * Exact solver for the singleton/pair exact-cover model via matching
+ * Without per-vehicle side constraints, covering every target exactly once by singletons (cost s_i) and pairs (cost
+ * c_ij) is a minimum-weight perfect matching problem (pairs are edges, singletons are edges to per-target dummy
+ * nodes). Equivalently, with savings w_ij = s_i + s_j - c_ij, the optimal cover is sum(s_i) minus a maximum-weight
+ * matching over the edges with positive savings, which is what is solved here, one connected component at a time.
+ * Savings are scaled to integers (MATCHING_WEIGHT_SCALE per unit of tour length), so the blossom algorithm runs in
+ * exact arithmetic; the reported objective is the exact tour sum of the chosen columns, within
+ * num_targets / (2 MATCHING_WEIGHT_SCALE) of the true optimum.
+ */
+
+struct MatchingStats {
+	int		num_edges;
+	int		num_components;
+	int		largest_component;
+	double	solve_seconds;
+};
+
+// Integer units per unit of tour length in the matching weights
+const double MATCHING_WEIGHT_SCALE = 1e6;
+
+/*
+ * Return the root of an element in a union-find forest (with path halving)
+ */
+int find_component(std::vector<int>& component_parent, int element) {
+	while (component_parent[element] != element) {
+		component_parent[element] = component_parent[component_parent[element]];
+		element = component_parent[element];
+	}
+
+	return element;
+}
+
+/*
+ * Solve the exact-cover model of the given columns by maximum-weight matching
+ * @param columns - Column arrays (singletons and pairs only)
+ * @param num_targets - Number of targets
+ * @param num_vehicles - Number of vehicles
+ * @param solution - Output: solution (accepted columns and vehicle tours; uncovered_targets is left to the caller)
+ * @param stats - Output: matching statistics
+ * Return false if the columns contain bundles larger than pairs (the matching model does not apply)
+ */
+bool solve_cover_by_matching(const BidColumns& columns, int num_targets, int num_vehicles, CvrpSolution& solution, MatchingStats& stats) {
+	auto solve_start = std::chrono::steady_clock::now();
+	int num_columns = columns.tour_lengths.size();
+	stats = MatchingStats();
+
+	// Cheapest singleton and pair column of each bundle (lowest column index on ties)
+	std::vector<int> best_singletons(num_targets, -1);
+	std::unordered_map<long long, int> best_pairs;
+	for (int column = 0; column < num_columns; column++) {
+		if (columns.target_ids_3[column] != -1) {
+			return false;
+		}
+
+		int target_id_1 = columns.target_ids_1[column];
+		int target_id_2 = columns.target_ids_2[column];
+		if (target_id_2 == -1) {
+			int& best = best_singletons[target_id_1];
+			if (best == -1 || columns.tour_lengths[column] < columns.tour_lengths[best]) {
+				best = column;
+			}
+		} else {
+			auto inserted = best_pairs.insert(std::make_pair((long long) target_id_1 * num_targets + target_id_2, column));
+			int& best = inserted.first->second;
+			if (!inserted.second && columns.tour_lengths[column] < columns.tour_lengths[best]) {
+				best = column;
+			}
+		}
+	}
+
+	// Edges with positive (integer-scaled) savings
+	std::vector<MatchingEdge> edges;
+	std::vector<int> edge_columns;
+	for (const auto& pair_entry : best_pairs) {
+		int column = pair_entry.second;
+		int target_id_1 = columns.target_ids_1[column];
+		int target_id_2 = columns.target_ids_2[column];
+		if (best_singletons[target_id_1] == -1 || best_singletons[target_id_2] == -1) {
+			continue;
+		}
+
+		double saving = columns.tour_lengths[best_singletons[target_id_1]] + columns.tour_lengths[best_singletons[target_id_2]]
+						- columns.tour_lengths[column];
+		long long weight = std::llround(saving * MATCHING_WEIGHT_SCALE);
+		if (weight > 0) {
+			MatchingEdge edge = {target_id_1, target_id_2, weight};
+			edges.push_back(edge);
+			edge_columns.push_back(column);
+		}
+	}
+
+	// Deterministic edge order (the map iteration order is not)
+	std::vector<int> edge_order(edges.size());
+	for (size_t i = 0; i < edge_order.size(); i++) {
+		edge_order[i] = i;
+	}
+	std::sort(edge_order.begin(), edge_order.end(), [&](int edge_1, int edge_2) {
+		return edge_columns[edge_1] < edge_columns[edge_2];
+	});
+	stats.num_edges = edges.size();
+
+	// Connected components of the savings graph
+	std::vector<int> component_parent(num_targets);
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		component_parent[target_id] = target_id;
+	}
+	for (const MatchingEdge& edge : edges) {
+		component_parent[find_component(component_parent, edge.vertex_1)] = find_component(component_parent, edge.vertex_2);
+	}
+
+	std::vector<int> component_index(num_targets, -1);
+	std::vector<std::vector<int>> component_targets;
+	std::vector<std::vector<int>> component_edges;
+	std::vector<int> local_index(num_targets);
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		int root = find_component(component_parent, target_id);
+		if (component_index[root] == -1) {
+			component_index[root] = component_targets.size();
+			component_targets.push_back(std::vector<int>());
+			component_edges.push_back(std::vector<int>());
+		}
+
+		std::vector<int>& targets_of_component = component_targets[component_index[root]];
+		local_index[target_id] = targets_of_component.size();
+		targets_of_component.push_back(target_id);
+	}
+	for (int edge : edge_order) {
+		component_edges[component_index[find_component(component_parent, edges[edge].vertex_1)]].push_back(edge);
+	}
+
+	// Maximum-weight matching of each component
+	std::vector<int> matched_column(num_targets, -1);
+	std::vector<MatchingEdge> local_edges;
+	for (size_t component = 0; component < component_targets.size(); component++) {
+		if (component_edges[component].empty()) {
+			continue;
+		}
+
+		stats.num_components++;
+		stats.largest_component = std::max(stats.largest_component, (int) component_targets[component].size());
+		local_edges.clear();
+		for (int edge : component_edges[component]) {
+			MatchingEdge local_edge = {local_index[edges[edge].vertex_1], local_index[edges[edge].vertex_2], edges[edge].weight};
+			local_edges.push_back(local_edge);
+		}
+
+		std::vector<int> mates = max_weight_matching(component_targets[component].size(), local_edges);
+		for (int edge : component_edges[component]) {
+			int target_id_1 = edges[edge].vertex_1;
+			int target_id_2 = edges[edge].vertex_2;
+			if (mates[local_index[target_id_1]] == local_index[target_id_2]) {
+				matched_column[target_id_1] = matched_column[target_id_2] = edge_columns[edge];
+			}
+		}
+	}
+
+	// Matched targets take their pair column, the others their singleton column
+	solution.accepted_columns.clear();
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (matched_column[target_id] != -1) {
+			if (columns.target_ids_1[matched_column[target_id]] == target_id) {
+				solution.accepted_columns.push_back(matched_column[target_id]);
+			}
+		} else if (best_singletons[target_id] != -1) {
+			solution.accepted_columns.push_back(best_singletons[target_id]);
+		}
+	}
+	std::sort(solution.accepted_columns.begin(), solution.accepted_columns.end());
+
+	solution.objective = 0;
+	solution.vehicle_tours.assign(num_vehicles, std::vector<int>());
+	for (int column : solution.accepted_columns) {
+		solution.objective += columns.tour_lengths[column];
+		solution.vehicle_tours[columns.vehicle_ids[column]].push_back(column);
+	}
+	solution.bound = solution.objective;
+	solution.stopped_at_deadline = false;
+
+	stats.solve_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count();
+	return true;
+}
@@ -0,0 +1,663 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+/*
+ * Maximum-weight matching in general graphs (Edmonds' blossom algorithm with a primal-dual method, O(n^3))
+ * Port of Joris van Rantwijk's reference implementation (mwmatching.py, public domain). Edge weights are integers;
+ * dual variables are stored doubled (dual_var[v] = 2 u(v)), so all arithmetic stays exact in integers.
+ * The matching maximizes total weight; it is not required to be perfect or of maximum cardinality.
+ */
+
+struct MatchingEdge {
+	int			vertex_1;
+	int			vertex_2;
+	long long	weight;
+};
+
+struct MaxWeightMatching {
+	int								num_vertices;
+	const std::vector<MatchingEdge>&	edges;
+	std::vector<int>				endpoint;				// endpoint[p] = vertex of edge p / 2 (p even: vertex_1, p odd: vertex_2)
+	std::vector<std::vector<int>>	neighbour_endpoints;	// Remote endpoints of the edges incident to each vertex
+	std::vector<int>				mate;					// Remote endpoint of the matched edge of each vertex (-1 if single)
+	std::vector<int>				label;					// 0 = unlabeled, 1 = S, 2 = T (top-level blossoms and vertices)
+	std::vector<int>				label_end;				// Endpoint through which a vertex or blossom got its label
+	std::vector<int>				in_blossom;				// Top-level blossom containing each vertex
+	std::vector<int>				blossom_parent;
+	std::vector<std::vector<int>>	blossom_children;		// Sub-blossoms in cyclic order, starting at the base
+	std::vector<int>				blossom_base;
+	std::vector<std::vector<int>>	blossom_endpoints;		// blossom_endpoints[b][i] connects blossom_children[b][i] and [i + 1]
+	std::vector<int>				best_edge;				// Least-slack edge to a different S-blossom
+	std::vector<std::vector<int>>	blossom_best_edges;		// Least-slack edges to neighbouring S-blossoms (S-blossoms only)
+	std::vector<bool>				has_blossom_best_edges;
+	std::vector<int>				unused_blossoms;
+	std::vector<long long>			dual_var;
+	std::vector<bool>				allow_edge;				// Edge is known to have zero slack
+	std::vector<int>				queue;					// S-vertices whose edges have not been scanned
+
+	MaxWeightMatching(int num_vertices, const std::vector<MatchingEdge>& edges) : num_vertices(num_vertices), edges(edges) {}
+
+	long long slack(int k) {
+		return dual_var[edges[k].vertex_1] + dual_var[edges[k].vertex_2] - 2 * edges[k].weight;
+	}
+
+	/*
+	 * Append the vertices contained in a (sub-)blossom
+	 */
+	void blossom_leaves(int b, std::vector<int>& leaves) {
+		if (b < num_vertices) {
+			leaves.push_back(b);
+		} else {
+			for (int t : blossom_children[b]) {
+				blossom_leaves(t, leaves);
+			}
+		}
+	}
+
+	/*
+	 * Return index into a blossom's cyclic child list, allowing negative indices
+	 */
+	static int cyclic(int j, int length) {
+		return ((j % length) + length) % length;
+	}
+
+	/*
+	 * Assign label t to the top-level blossom containing vertex w, reached through endpoint p
+	 */
+	void assign_label(int w, int t, int p) {
+		int b = in_blossom[w];
+		label[w] = label[b] = t;
+		label_end[w] = label_end[b] = p;
+		best_edge[w] = best_edge[b] = -1;
+
+		if (t == 1) {
+			// b became an S-blossom: scan its vertices
+			blossom_leaves(b, queue);
+		} else if (t == 2) {
+			// b became a T-blossom: label its mate S
+			int base = blossom_base[b];
+			assign_label(endpoint[mate[base]], 1, mate[base] ^ 1);
+		}
+	}
+
+	/*
+	 * Trace back from S-vertices v and w to find a new blossom (return its base) or an augmenting path (return -1)
+	 */
+	int scan_blossom(int v, int w) {
+		std::vector<int> path;
+		int base = -1;
+
+		while (v != -1 || w != -1) {
+			int b = in_blossom[v];
+			if (label[b] & 4) {
+				base = blossom_base[b];
+				break;
+			}
+
+			path.push_back(b);
+			label[b] = 5;
+			if (label_end[b] == -1) {
+				v = -1;
+			} else {
+				v = endpoint[label_end[b]];
+				b = in_blossom[v];
+				v = endpoint[label_end[b]];
+			}
+
+			if (w != -1) {
+				std::swap(v, w);
+			}
+		}
+
+		for (int b : path) {
+			label[b] = 1;
+		}
+
+		return base;
+	}
+
+	/*
+	 * Construct a new blossom with the given base, through S-vertices joined by edge k
+	 */
+	void add_blossom(int base, int k) {
+		int v = edges[k].vertex_1;
+		int w = edges[k].vertex_2;
+		int bb = in_blossom[base];
+		int bv = in_blossom[v];
+		int bw = in_blossom[w];
+
+		int b = unused_blossoms.back();
+		unused_blossoms.pop_back();
+		blossom_base[b] = base;
+		blossom_parent[b] = -1;
+		blossom_parent[bb] = b;
+
+		std::vector<int>& path = blossom_children[b];
+		std::vector<int>& endps = blossom_endpoints[b];
+		path.clear();
+		endps.clear();
+
+		// Trace back from v to base
+		while (bv != bb) {
+			blossom_parent[bv] = b;
+			path.push_back(bv);
+			endps.push_back(label_end[bv]);
+			v = endpoint[label_end[bv]];
+			bv = in_blossom[v];
+		}
+
+		path.push_back(bb);
+		std::reverse(path.begin(), path.end());
+		std::reverse(endps.begin(), endps.end());
+		endps.push_back(2 * k);
+
+		// Trace back from w to base
+		while (bw != bb) {
+			blossom_parent[bw] = b;
+			path.push_back(bw);
+			endps.push_back(label_end[bw] ^ 1);
+			w = endpoint[label_end[bw]];
+			bw = in_blossom[w];
+		}
+
+		label[b] = 1;
+		label_end[b] = label_end[bb];
+		dual_var[b] = 0;
+
+		std::vector<int> leaves;
+		blossom_leaves(b, leaves);
+		for (int leaf : leaves) {
+			// Former T-vertices become S-vertices and must be scanned
+			if (label[in_blossom[leaf]] == 2) {
+				queue.push_back(leaf);
+			}
+			in_blossom[leaf] = b;
+		}
+
+		// Least-slack edges from the new blossom to each neighbouring S-blossom
+		std::vector<int> best_edge_to(2 * num_vertices, -1);
+		for (int sub_blossom : path) {
+			std::vector<int> neighbour_edges;
+			if (!has_blossom_best_edges[sub_blossom]) {
+				std::vector<int> sub_leaves;
+				blossom_leaves(sub_blossom, sub_leaves);
+				for (int leaf : sub_leaves) {
+					for (int p : neighbour_endpoints[leaf]) {
+						neighbour_edges.push_back(p / 2);
+					}
+				}
+			} else {
+				neighbour_edges = blossom_best_edges[sub_blossom];
+			}
+
+			for (int edge : neighbour_edges) {
+				int i = edges[edge].vertex_1;
+				int j = edges[edge].vertex_2;
+				if (in_blossom[j] == b) {
+					std::swap(i, j);
+				}
+
+				int bj = in_blossom[j];
+				if (bj != b && label[bj] == 1 && (best_edge_to[bj] == -1 || slack(edge) < slack(best_edge_to[bj]))) {
+					best_edge_to[bj] = edge;
+				}
+			}
+
+			blossom_best_edges[sub_blossom].clear();
+			has_blossom_best_edges[sub_blossom] = false;
+			best_edge[sub_blossom] = -1;
+		}
+
+		blossom_best_edges[b].clear();
+		for (int edge : best_edge_to) {
+			if (edge != -1) {
+				blossom_best_edges[b].push_back(edge);
+			}
+		}
+		has_blossom_best_edges[b] = true;
+
+		best_edge[b] = -1;
+		for (int edge : blossom_best_edges[b]) {
+			if (best_edge[b] == -1 || slack(edge) < slack(best_edge[b])) {
+				best_edge[b] = edge;
+			}
+		}
+	}
+
+	/*
+	 * Expand a top-level blossom (at the end of a stage, or when its dual variable reaches zero as a T-blossom)
+	 */
+	void expand_blossom(int b, bool end_stage) {
+		std::vector<int> leaves;
+		for (int s : blossom_children[b]) {
+			blossom_parent[s] = -1;
+			if (s < num_vertices) {
+				in_blossom[s] = s;
+			} else if (end_stage && dual_var[s] == 0) {
+				expand_blossom(s, end_stage);
+			} else {
+				leaves.clear();
+				blossom_leaves(s, leaves);
+				for (int leaf : leaves) {
+					in_blossom[leaf] = s;
+				}
+			}
+		}
+
+		// Relabel the sub-blossoms of an expanded T-blossom along the even-length path to its entry child
+		if (!end_stage && label[b] == 2) {
+			std::vector<int>& children = blossom_children[b];
+			std::vector<int>& endps = blossom_endpoints[b];
+			int length = children.size();
+			int entry_child = in_blossom[endpoint[label_end[b] ^ 1]];
+			int j = std::find(children.begin(), children.end(), entry_child) - children.begin();
+			int j_step, endpoint_trick;
+
+			if (j & 1) {
+				// Odd start index: go forward and wrap
+				j -= length;
+				j_step = 1;
+				endpoint_trick = 0;
+			} else {
+				// Even start index: go backward
+				j_step = -1;
+				endpoint_trick = 1;
+			}
+
+			// Move along the blossom until the base
+			int p = label_end[b];
+			while (j != 0) {
+				// Relabel the T-sub-blossom
+				label[endpoint[p ^ 1]] = 0;
+				label[endpoint[endps[cyclic(j - endpoint_trick, length)] ^ endpoint_trick ^ 1]] = 0;
+				assign_label(endpoint[p ^ 1], 2, p);
+
+				// Step to the next S-sub-blossom and note its forward endpoint
+				allow_edge[endps[cyclic(j - endpoint_trick, length)] / 2] = true;
+				j += j_step;
+				p = endps[cyclic(j - endpoint_trick, length)] ^ endpoint_trick;
+
+				// Step to the next T-sub-blossom
+				allow_edge[p / 2] = true;
+				j += j_step;
+			}
+
+			// Relabel the base T-sub-blossom without stepping through to its mate
+			int bv = children[cyclic(j, length)];
+			label[endpoint[p ^ 1]] = label[bv] = 2;
+			label_end[endpoint[p ^ 1]] = label_end[bv] = p;
+			best_edge[bv] = -1;
+
+			// Continue along the blossom until back at the entry child
+			j += j_step;
+			while (children[cyclic(j, length)] != entry_child) {
+				bv = children[cyclic(j, length)];
+				if (label[bv] == 1) {
+					j += j_step;
+					continue;
+				}
+
+				// Sub-blossom reached from outside (through a T-vertex)
+				leaves.clear();
+				blossom_leaves(bv, leaves);
+				int labeled_leaf = -1;
+				for (int leaf : leaves) {
+					if (label[leaf] != 0) {
+						labeled_leaf = leaf;
+						break;
+					}
+				}
+
+				if (labeled_leaf != -1) {
+					label[labeled_leaf] = 0;
+					label[endpoint[mate[blossom_base[bv]]]] = 0;
+					assign_label(labeled_leaf, 2, label_end[labeled_leaf]);
+				}
+				j += j_step;
+			}
+		}
+
+		// Recycle the blossom number
+		label[b] = label_end[b] = -1;
+		blossom_children[b].clear();
+		blossom_endpoints[b].clear();
+		blossom_base[b] = -1;
+		blossom_best_edges[b].clear();
+		has_blossom_best_edges[b] = false;
+		best_edge[b] = -1;
+		unused_blossoms.push_back(b);
+	}
+
+	/*
+	 * Swap matched and unmatched edges over an alternating path through blossom b between vertex v and the base
+	 */
+	void augment_blossom(int b, int v) {
+		// Sub-blossom of b containing v
+		int t = v;
+		while (blossom_parent[t] != b) {
+			t = blossom_parent[t];
+		}
+
+		if (t >= num_vertices) {
+			augment_blossom(t, v);
+		}
+
+		std::vector<int>& children = blossom_children[b];
+		std::vector<int>& endps = blossom_endpoints[b];
+		int length = children.size();
+		int i = std::find(children.begin(), children.end(), t) - children.begin();
+		int j = i;
+		int j_step, endpoint_trick;
+
+		if (i & 1) {
+			j -= length;
+			j_step = 1;
+			endpoint_trick = 0;
+		} else {
+			j_step = -1;
+			endpoint_trick = 1;
+		}
+
+		// Move along the blossom until the base
+		while (j != 0) {
+			j += j_step;
+			t = children[cyclic(j, length)];
+			int p = endps[cyclic(j - endpoint_trick, length)] ^ endpoint_trick;
+			if (t >= num_vertices) {
+				augment_blossom(t, endpoint[p]);
+			}
+
+			j += j_step;
+			t = children[cyclic(j, length)];
+			if (t >= num_vertices) {
+				augment_blossom(t, endpoint[p ^ 1]);
+			}
+
+			// Match the edge connecting those sub-blossoms
+			mate[endpoint[p]] = p ^ 1;
+			mate[endpoint[p ^ 1]] = p;
+		}
+
+		// Rotate the child list so the new base comes first
+		std::rotate(children.begin(), children.begin() + i, children.end());
+		std::rotate(endps.begin(), endps.begin() + i, endps.end());
+		blossom_base[b] = blossom_base[children[0]];
+	}
+
+	/*
+	 * Swap matched and unmatched edges over the augmenting path through edge k between two single vertices
+	 */
+	void augment_matching(int k) {
+		int starts[2][2] = {{edges[k].vertex_1, 2 * k + 1}, {edges[k].vertex_2, 2 * k}};
+		for (auto& start : starts) {
+			int s = start[0];
+			int p = start[1];
+
+			while (true) {
+				int bs = in_blossom[s];
+				if (bs >= num_vertices) {
+					augment_blossom(bs, s);
+				}
+
+				mate[s] = p;
+
+				// Reached a single vertex: path end
+				if (label_end[bs] == -1) {
+					break;
+				}
+
+				int t = endpoint[label_end[bs]];
+				int bt = in_blossom[t];
+				s = endpoint[label_end[bt]];
+				int j = endpoint[label_end[bt] ^ 1];
+				if (bt >= num_vertices) {
+					augment_blossom(bt, j);
+				}
+
+				mate[j] = label_end[bt];
+				p = label_end[bt] ^ 1;
+			}
+		}
+	}
+
+	/*
+	 * Compute the matching
+	 * Return the mate of each vertex (-1 if unmatched)
+	 */
+	std::vector<int> solve() {
+		int num_edges = edges.size();
+		long long max_weight = 0;
+		for (const MatchingEdge& edge : edges) {
+			max_weight = std::max(max_weight, edge.weight);
+		}
+
+		endpoint.resize(2 * num_edges);
+		neighbour_endpoints.assign(num_vertices, std::vector<int>());
+		for (int k = 0; k < num_edges; k++) {
+			endpoint[2 * k] = edges[k].vertex_1;
+			endpoint[2 * k + 1] = edges[k].vertex_2;
+			neighbour_endpoints[edges[k].vertex_1].push_back(2 * k + 1);
+			neighbour_endpoints[edges[k].vertex_2].push_back(2 * k);
+		}
+
+		mate.assign(num_vertices, -1);
+		label.assign(2 * num_vertices, 0);
+		label_end.assign(2 * num_vertices, -1);
+		in_blossom.resize(num_vertices);
+		blossom_parent.assign(2 * num_vertices, -1);
+		blossom_children.assign(2 * num_vertices, std::vector<int>());
+		blossom_base.assign(2 * num_vertices, -1);
+		blossom_endpoints.assign(2 * num_vertices, std::vector<int>());
+		best_edge.assign(2 * num_vertices, -1);
+		blossom_best_edges.assign(2 * num_vertices, std::vector<int>());
+		has_blossom_best_edges.assign(2 * num_vertices, false);
+		unused_blossoms.clear();
+		dual_var.assign(2 * num_vertices, 0);
+		allow_edge.assign(num_edges, false);
+
+		for (int v = 0; v < num_vertices; v++) {
+			in_blossom[v] = v;
+			blossom_base[v] = v;
+			dual_var[v] = max_weight;
+			unused_blossoms.push_back(num_vertices + v);
+		}
+
+		// Each stage finds one augmenting path (or proves none improves the weight)
+		for (int stage = 0; stage < num_vertices; stage++) {
+			std::fill(label.begin(), label.end(), 0);
+			std::fill(best_edge.begin(), best_edge.end(), -1);
+			for (int b = num_vertices; b < 2 * num_vertices; b++) {
+				blossom_best_edges[b].clear();
+				has_blossom_best_edges[b] = false;
+			}
+			std::fill(allow_edge.begin(), allow_edge.end(), false);
+			queue.clear();
+
+			// Label single top-level blossoms S
+			for (int v = 0; v < num_vertices; v++) {
+				if (mate[v] == -1 && label[in_blossom[v]] == 0) {
+					assign_label(v, 1, -1);
+				}
+			}
+
+			bool augmented = false;
+			while (true) {
+				// Grow the alternating forest from the queued S-vertices
+				while (!queue.empty() && !augmented) {
+					int v = queue.back();
+					queue.pop_back();
+
+					for (int p : neighbour_endpoints[v]) {
+						int k = p / 2;
+						int w = endpoint[p];
+						if (in_blossom[v] == in_blossom[w]) {
+							continue;
+						}
+
+						long long k_slack = 0;
+						if (!allow_edge[k]) {
+							k_slack = slack(k);
+							if (k_slack <= 0) {
+								allow_edge[k] = true;
+							}
+						}
+
+						if (allow_edge[k]) {
+							if (label[in_blossom[w]] == 0) {
+								// w is free: label it T and its mate S
+								assign_label(w, 2, p ^ 1);
+							} else if (label[in_blossom[w]] == 1) {
+								// w is an S-vertex: new blossom or augmenting path
+								int base = scan_blossom(v, w);
+								if (base >= 0) {
+									add_blossom(base, k);
+								} else {
+									augment_matching(k);
+									augmented = true;
+									break;
+								}
+							} else if (label[w] == 0) {
+								// w is inside a T-blossom but not yet reached from an S-vertex
+								label[w] = 2;
+								label_end[w] = p ^ 1;
+							}
+						} else if (label[in_blossom[w]] == 1) {
+							// Track the least-slack edge to a different S-blossom
+							int b = in_blossom[v];
+							if (best_edge[b] == -1 || k_slack < slack(best_edge[b])) {
+								best_edge[b] = k;
+							}
+						} else if (label[w] == 0) {
+							// Track the least-slack edge to a free vertex (or unreached vertex of a T-blossom)
+							if (best_edge[w] == -1 || k_slack < slack(best_edge[w])) {
+								best_edge[w] = k;
+							}
+						}
+					}
+				}
+
+				if (augmented) {
+					break;
+				}
+
+				// No further progress with tight edges: compute the dual update
+				int delta_type = 1;
+				long long delta = dual_var[0];
+				int delta_edge = -1;
+				int delta_blossom = -1;
+
+				// Type 1: minimum vertex dual (the matching is optimal once it reaches zero)
+				for (int v = 0; v < num_vertices; v++) {
+					delta = std::min(delta, dual_var[v]);
+				}
+
+				// Type 2: least-slack edge between an S-vertex and a free vertex
+				for (int v = 0; v < num_vertices; v++) {
+					if (label[in_blossom[v]] == 0 && best_edge[v] != -1) {
+						long long d = slack(best_edge[v]);
+						if (d < delta) {
+							delta = d;
+							delta_type = 2;
+							delta_edge = best_edge[v];
+						}
+					}
+				}
+
+				// Type 3: half the least-slack edge between two S-blossoms
+				for (int b = 0; b < 2 * num_vertices; b++) {
+					if (blossom_parent[b] == -1 && label[b] == 1 && best_edge[b] != -1) {
+						long long d = slack(best_edge[b]) / 2;
+						if (d < delta) {
+							delta = d;
+							delta_type = 3;
+							delta_edge = best_edge[b];
+						}
+					}
+				}
+
+				// Type 4: minimum dual of a T-blossom
+				for (int b = num_vertices; b < 2 * num_vertices; b++) {
+					if (blossom_base[b] >= 0 && blossom_parent[b] == -1 && label[b] == 2 && dual_var[b] < delta) {
+						delta = dual_var[b];
+						delta_type = 4;
+						delta_blossom = b;
+					}
+				}
+
+				// Update the dual variables
+				for (int v = 0; v < num_vertices; v++) {
+					if (label[in_blossom[v]] == 1) {
+						dual_var[v] -= delta;
+					} else if (label[in_blossom[v]] == 2) {
+						dual_var[v] += delta;
+					}
+				}
+
+				for (int b = num_vertices; b < 2 * num_vertices; b++) {
+					if (blossom_base[b] >= 0 && blossom_parent[b] == -1) {
+						if (label[b] == 1) {
+							dual_var[b] += delta;
+						} else if (label[b] == 2) {
+							dual_var[b] -= delta;
+						}
+					}
+				}
+
+				// Take action at the point where the minimum delta occurred
+				if (delta_type == 1) {
+					break;
+				} else if (delta_type == 2) {
+					allow_edge[delta_edge] = true;
+					int i = edges[delta_edge].vertex_1;
+					if (label[in_blossom[i]] == 0) {
+						i = edges[delta_edge].vertex_2;
+					}
+					queue.push_back(i);
+				} else if (delta_type == 3) {
+					allow_edge[delta_edge] = true;
+					queue.push_back(edges[delta_edge].vertex_1);
+				} else {
+					expand_blossom(delta_blossom, false);
+				}
+			}
+
+			// Optimal: no augmenting path improves the weight
+			if (!augmented) {
+				break;
+			}
+
+			// End of stage: expand S-blossoms whose dual variable is zero
+			for (int b = num_vertices; b < 2 * num_vertices; b++) {
+				if (blossom_parent[b] == -1 && blossom_base[b] >= 0 && label[b] == 1 && dual_var[b] == 0) {
+					expand_blossom(b, true);
+				}
+			}
+		}
+
+		// Convert remote endpoints to vertices
+		std::vector<int> mates(num_vertices, -1);
+		for (int v = 0; v < num_vertices; v++) {
+			if (mate[v] >= 0) {
+				mates[v] = endpoint[mate[v]];
+			}
+		}
+
+		return mates;
+	}
+};
+
+/*
+ * Return a maximum-weight matching of a general graph
+ * @param num_vertices - Number of vertices (IDs 0 .. num_vertices - 1)
+ * @param edges - Edges with integer weights (no self loops)
+ * Return the mate of each vertex (-1 if unmatched)
+ */
+std::vector<int> max_weight_matching(int num_vertices, const std::vector<MatchingEdge>& edges) {
+	if (num_vertices == 0 || edges.empty()) {
+		return std::vector<int>(num_vertices, -1);
+	}
+
+	MaxWeightMatching matching(num_vertices, edges);
+	return matching.solve();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "gurobi_c++.h"
+
+/*
+ * MIP starts and incumbent timing
+ * A heuristic solution is handed to Gurobi through the Start attribute of the variables (one bulk set), and a
+ * callback records every new incumbent (solver runtime, objective and bound at that point), so the effect of the start
+ * and the anytime profile of a solve stopped by a deadline can be logged.
+ */
+
+struct IncumbentRecord {
+	double	seconds;		// Solver runtime when the incumbent was found
+	double	objective;
+	double	bound;			// Best bound at that point
+};
+
+class IncumbentTimer : public GRBCallback {
+public:
+	double							first_incumbent_seconds = -1;	// Solver runtime at the first incumbent (-1 if none was found)
+	double							first_incumbent_objective = 0;
+	int								num_incumbents = 0;
+	std::vector<IncumbentRecord>	incumbents;						// Improving incumbents, in the order they were found
+
+protected:
+	void callback() {
+		if (where == GRB_CB_MIPSOL) {
+			IncumbentRecord incumbent = {getDoubleInfo(GRB_CB_RUNTIME), getDoubleInfo(GRB_CB_MIPSOL_OBJ), getDoubleInfo(GRB_CB_MIPSOL_OBJBND)};
+			if (first_incumbent_seconds < 0) {
+				first_incumbent_seconds = incumbent.seconds;
+				first_incumbent_objective = incumbent.objective;
+			}
+			if (incumbents.empty() || incumbent.objective < incumbents.back().objective) {
+				incumbents.push_back(incumbent);
+			}
+			num_incumbents++;
+		}
+	}
+};
+
+/*
+ * Set a MIP start on the given variables
+ * @param model - GRB model
+ * @param vars - Variables of the start
+ * @param selected - Start value of each variable (nonzero = 1)
+ */
+void set_mip_start(GRBModel& model, const std::vector<GRBVar>& vars, const std::vector<char>& selected) {
+	std::vector<double> start_values(vars.size());
+	for (size_t i = 0; i < vars.size(); i++) {
+		start_values[i] = selected[i] ? 1.0 : 0.0;
+	}
+
+	model.set(GRB_DoubleAttr_Start, vars.data(), start_values.data(), vars.size());
+}
+
+/*
+ * Greedy maximal-weight independent set: vertices are taken in decreasing weight / (degree + 1) order (lowest index
+ * on ties) whenever none of their neighbours has been taken
+ * @param weights - Weight of each vertex
+ * @param edges - Edges (vertex index pairs)
+ * @param in_set - Output: whether each vertex is in the independent set
+ * Return the weight of the independent set
+ */
+double greedy_independent_set(const std::vector<double>& weights, const std::vector<std::pair<int, int>>& edges, std::vector<char>& in_set) {
+	int num_vertices = weights.size();
+
+	// Adjacency lists (CSR)
+	std::vector<int> adjacency_start(num_vertices + 1, 0);
+	for (const std::pair<int, int>& edge : edges) {
+		adjacency_start[edge.first + 1]++;
+		adjacency_start[edge.second + 1]++;
+	}
+	for (int vertex = 0; vertex < num_vertices; vertex++) {
+		adjacency_start[vertex + 1] += adjacency_start[vertex];
+	}
+
+	std::vector<int> adjacency(adjacency_start[num_vertices]);
+	std::vector<int> fill(adjacency_start.begin(), adjacency_start.end() - 1);
+	for (const std::pair<int, int>& edge : edges) {
+		adjacency[fill[edge.first]++] = edge.second;
+		adjacency[fill[edge.second]++] = edge.first;
+	}
+
+	std::vector<double> scores(num_vertices);
+	std::vector<int> order(num_vertices);
+	for (int vertex = 0; vertex < num_vertices; vertex++) {
+		scores[vertex] = weights[vertex] / (adjacency_start[vertex + 1] - adjacency_start[vertex] + 1);
+		order[vertex] = vertex;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](int vertex_1, int vertex_2) {
+		return scores[vertex_1] > scores[vertex_2];
+	});
+
+	// Take each vertex unless a neighbour was taken before it
+	in_set.assign(num_vertices, 0);
+	std::vector<char> blocked(num_vertices, 0);
+	double total_weight = 0;
+	for (int vertex : order) {
+		if (blocked[vertex]) {
+			continue;
+		}
+
+		in_set[vertex] = 1;
+		total_weight += weights[vertex];
+		for (int i = adjacency_start[vertex]; i < adjacency_start[vertex + 1]; i++) {
+			blocked[adjacency[i]] = 1;
+		}
+	}
+
+	return total_weight;
+}
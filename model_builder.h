@@ -0,0 +1,417 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+#include "gurobi_c++.h"
+#include "bid_generation.h"
+
+/*
+ * Bulk Gurobi model construction
+ * Bids are collected into flat column arrays plus a sparse (CSR) exact-cover row per target. All bid variables are
+ * created with their objective coefficients in a single addVars call, and each cover row is added from its index
+ * array, so no GRBLinExpr objective or per-term temporaries are built.
+ */
+
+struct BidColumns {
+	std::vector<double>	tour_lengths;		// Objective coefficient of each column
+	std::vector<int>	vehicle_ids;
+	std::vector<int>	target_ids_1;
+	std::vector<int>	target_ids_2;		// -1 for singleton bids
+	std::vector<int>	target_ids_3;		// -1 for singleton and pair bids (triples only come from column generation)
+	std::vector<int>	cover_row_start;	// Cover row of target t is cover_row_bids[cover_row_start[t], cover_row_start[t + 1])
+	std::vector<int>	cover_row_bids;		// Column indices, ascending within each row
+};
+
+struct CvrpSolution {
+	double							objective;
+	std::vector<int>				accepted_columns;	// Columns with value 1, ascending
+	std::vector<std::vector<int>>	vehicle_tours;		// Accepted columns of each vehicle (indexed by vehicle ID)
+	std::vector<int>				uncovered_targets;	// Targets no vehicle can carry (left out of the cover constraints)
+	double							bound = 0;			// Best lower bound on the objective (equal to it when solved exactly)
+	bool							stopped_at_deadline = false;	// Best incumbent when the solve deadline hit, not a proven optimum
+};
+
+struct ModelBuildStats {
+	int			num_columns;
+	long long	num_nonzeros;
+	double		build_seconds;
+	long		peak_rss_kb;
+};
+
+/*
+ * Return peak resident set size of the process in KB
+ */
+long peak_rss_kb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;	// Reported in bytes on macOS
+#else
+	return usage.ru_maxrss;			// Reported in KB on Linux
+#endif
+}
+
+/*
+ * Return the targets of a column
+ * @param columns - Column arrays
+ * @param column - Column index
+ * @param target_ids - Output: target IDs of the column (ascending)
+ * Return the number of targets
+ */
+int column_targets(const BidColumns& columns, int column, int target_ids[3]) {
+	int num_column_targets = 0;
+	int column_target_ids[3] = {columns.target_ids_1[column], columns.target_ids_2[column], columns.target_ids_3[column]};
+	for (int target_id : column_target_ids) {
+		if (target_id != -1) {
+			target_ids[num_column_targets++] = target_id;
+		}
+	}
+
+	return num_column_targets;
+}
+
+/*
+ * Build the per-target cover rows (CSR) of the current column arrays
+ * @param columns - Column arrays; cover rows are rebuilt
+ * @param num_targets - Number of targets
+ */
+void build_cover_rows(BidColumns& columns, int num_targets) {
+	int num_columns = columns.tour_lengths.size();
+	int target_ids[3];
+	columns.cover_row_start.assign(num_targets + 1, 0);
+
+	// Row lengths
+	for (int column = 0; column < num_columns; column++) {
+		int num_column_targets = column_targets(columns, column, target_ids);
+		for (int i = 0; i < num_column_targets; i++) {
+			columns.cover_row_start[target_ids[i] + 1]++;
+		}
+	}
+
+	// Row offsets
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		columns.cover_row_start[target_id + 1] += columns.cover_row_start[target_id];
+	}
+
+	// Row contents
+	columns.cover_row_bids.resize(columns.cover_row_start[num_targets]);
+	std::vector<int> row_fill(columns.cover_row_start.begin(), columns.cover_row_start.end() - 1);
+	for (int column = 0; column < num_columns; column++) {
+		int num_column_targets = column_targets(columns, column, target_ids);
+		for (int i = 0; i < num_column_targets; i++) {
+			columns.cover_row_bids[row_fill[target_ids[i]]++] = column;
+		}
+	}
+}
+
+/*
+ * Collect generated bids into flat column arrays and per-target cover rows
+ * @param bids - Generated bids (column order)
+ * @param num_targets - Number of targets
+ * @param columns - Output: column arrays and cover rows
+ */
+void collect_bid_columns(const std::vector<BidRecord>& bids, int num_targets, BidColumns& columns) {
+	int num_columns = bids.size();
+	columns.tour_lengths.resize(num_columns);
+	columns.vehicle_ids.resize(num_columns);
+	columns.target_ids_1.resize(num_columns);
+	columns.target_ids_2.resize(num_columns);
+	columns.target_ids_3.assign(num_columns, -1);
+
+	// Column arrays
+	for (int column = 0; column < num_columns; column++) {
+		const BidRecord& bid = bids[column];
+		columns.tour_lengths[column] = bid.tour_length;
+		columns.vehicle_ids[column] = bid.vehicle_id;
+		columns.target_ids_1[column] = bid.target_id_1;
+		columns.target_ids_2[column] = bid.target_id_2;
+	}
+
+	build_cover_rows(columns, num_targets);
+}
+
+/*
+ * Return the variable name of a bid column ("vehicle,target_1[,target_2[,target_3]]")
+ * @param columns - Column arrays
+ * @param column - Column index
+ */
+std::string bid_column_name(const BidColumns& columns, int column) {
+	int target_ids[3];
+	int num_column_targets = column_targets(columns, column, target_ids);
+	std::string name = std::to_string(columns.vehicle_ids[column]);
+	for (int i = 0; i < num_column_targets; i++) {
+		name += "," + std::to_string(target_ids[i]);
+	}
+
+	return name;
+}
+
+/*
+ * Create all bid variables with their objective coefficients in one call
+ * @param model - GRB model (objective sense is set to minimize)
+ * @param columns - Column arrays
+ * @param with_names - Whether to name variables ("vehicle,target_1[,target_2]")
+ * @param bid_vars - Output: variable of each column
+ * @param var_type - Variable type (GRB_CONTINUOUS for the LP relaxation)
+ */
+void add_bid_variables(GRBModel& model, const BidColumns& columns, bool with_names, std::vector<GRBVar>& bid_vars, char var_type = GRB_BINARY) {
+	int num_columns = columns.tour_lengths.size();
+	std::vector<double> lower_bounds(num_columns, 0.0);
+	std::vector<double> upper_bounds(num_columns, 1.0);
+	std::vector<char> types(num_columns, var_type);
+	std::vector<std::string> names;
+
+	if (with_names) {
+		names.reserve(num_columns);
+		for (int column = 0; column < num_columns; column++) {
+			names.push_back(bid_column_name(columns, column));
+		}
+	}
+
+	model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+	GRBVar* vars = model.addVars(lower_bounds.data(), upper_bounds.data(), columns.tour_lengths.data(), types.data(),
+								 with_names ? names.data() : NULL, num_columns);
+	bid_vars.assign(vars, vars + num_columns);
+	delete[] vars;
+}
+
+/*
+ * Return targets that no bid covers (their weight exceeds every vehicle's capacity)
+ * @param columns - Column arrays and cover rows
+ */
+std::vector<int> uncoverable_targets(const BidColumns& columns) {
+	std::vector<int> uncovered_targets;
+	int num_targets = (int) columns.cover_row_start.size() - 1;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (columns.cover_row_start[target_id] == columns.cover_row_start[target_id + 1]) {
+			uncovered_targets.push_back(target_id);
+		}
+	}
+
+	return uncovered_targets;
+}
+
+/*
+ * Greedy savings heuristic for the exact cover: every coverable target starts on its cheapest singleton column, then
+ * bundle columns are accepted in decreasing savings order (sum of their targets' singleton tour lengths minus their
+ * own, lowest column on ties) while all of their targets are still on singletons
+ * @param columns - Column arrays and cover rows
+ * @param selected - Output: whether each column is in the heuristic cover
+ * Return the tour sum of the heuristic cover
+ */
+double greedy_savings_cover(const BidColumns& columns, std::vector<char>& selected) {
+	int num_targets = columns.cover_row_start.size() - 1;
+	int num_columns = columns.tour_lengths.size();
+	int target_ids[3];
+
+	// Cheapest singleton column of each target
+	std::vector<int> best_singletons(num_targets, -1);
+	for (int column = 0; column < num_columns; column++) {
+		if (column_targets(columns, column, target_ids) == 1) {
+			int& best = best_singletons[target_ids[0]];
+			if (best == -1 || columns.tour_lengths[column] < columns.tour_lengths[best]) {
+				best = column;
+			}
+		}
+	}
+
+	// Bundle columns with positive savings
+	std::vector<std::pair<double, int>> savings;
+	for (int column = 0; column < num_columns; column++) {
+		int num_column_targets = column_targets(columns, column, target_ids);
+		if (num_column_targets == 1) {
+			continue;
+		}
+
+		double saving = -columns.tour_lengths[column];
+		for (int i = 0; i < num_column_targets; i++) {
+			saving += best_singletons[target_ids[i]] != -1 ? columns.tour_lengths[best_singletons[target_ids[i]]] : 0;
+		}
+		if (saving > 0) {
+			savings.push_back(std::make_pair(-saving, column));
+		}
+	}
+	std::sort(savings.begin(), savings.end());
+
+	// Accept bundles whose targets are all still free
+	std::vector<char> bundled(num_targets, 0);
+	selected.assign(num_columns, 0);
+	double objective = 0;
+	for (const std::pair<double, int>& saving : savings) {
+		int num_column_targets = column_targets(columns, saving.second, target_ids);
+		bool free = true;
+		for (int i = 0; i < num_column_targets; i++) {
+			free = free && !bundled[target_ids[i]];
+		}
+		if (!free) {
+			continue;
+		}
+
+		selected[saving.second] = 1;
+		objective += columns.tour_lengths[saving.second];
+		for (int i = 0; i < num_column_targets; i++) {
+			bundled[target_ids[i]] = 1;
+		}
+	}
+
+	// Remaining targets keep their singleton
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (!bundled[target_id] && best_singletons[target_id] != -1) {
+			selected[best_singletons[target_id]] = 1;
+			objective += columns.tour_lengths[best_singletons[target_id]];
+		}
+	}
+
+	return objective;
+}
+
+/*
+ * Add one exact-cover constraint per coverable target from the sparse cover rows
+ * (targets without any bid are skipped rather than making the model infeasible)
+ * @param model - GRB model
+ * @param columns - Column arrays and cover rows
+ * @param bid_vars - Variable of each column
+ * @param cover_constrs - Output: cover constraint of each target (indexed by target ID; unset for skipped targets)
+ */
+void add_cover_constraints(GRBModel& model, const BidColumns& columns, const std::vector<GRBVar>& bid_vars, std::vector<GRBConstr>& cover_constrs) {
+	int num_targets = columns.cover_row_start.size() - 1;
+	std::vector<GRBVar> row_vars;
+	std::vector<double> row_coeffs;
+	cover_constrs.assign(num_targets, GRBConstr());
+
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		if (columns.cover_row_start[target_id] == columns.cover_row_start[target_id + 1]) {
+			continue;
+		}
+
+		row_vars.clear();
+		for (int i = columns.cover_row_start[target_id]; i < columns.cover_row_start[target_id + 1]; i++) {
+			row_vars.push_back(bid_vars[columns.cover_row_bids[i]]);
+		}
+		row_coeffs.assign(row_vars.size(), 1.0);
+
+		// Constraint: target must be serviced exactly once
+		GRBLinExpr target_constraint;
+		target_constraint.addTerms(row_coeffs.data(), row_vars.data(), row_vars.size());
+		cover_constrs[target_id] = model.addConstr(target_constraint, GRB_EQUAL, 1.0);
+	}
+}
+
+/*
+ * Choose a vehicle for each accepted column among the vehicles tied for it (the tour sum is unchanged)
+ * Columns without ties keep their vehicle; tied columns go to the tied vehicle with the fewest tours so far.
+ * @param columns - Column arrays
+ * @param ties - Tied vehicles of each column (columns beyond the recorded ones have no ties)
+ * @param solution - Solution whose vehicle tours are reassigned
+ */
+void assign_tied_vehicles(const BidColumns& columns, const TiedVehicles& ties, CvrpSolution& solution) {
+	int num_tied_columns = ties.start.empty() ? 0 : ties.start.size() - 1;
+	std::vector<int> tied_columns;
+	for (std::vector<int>& tours : solution.vehicle_tours) {
+		tours.clear();
+	}
+
+	// Untied columns first, so the tied ones balance around them
+	for (int column : solution.accepted_columns) {
+		if (column < num_tied_columns && ties.start[column + 1] - ties.start[column] > 1) {
+			tied_columns.push_back(column);
+		} else {
+			solution.vehicle_tours[columns.vehicle_ids[column]].push_back(column);
+		}
+	}
+
+	for (int column : tied_columns) {
+		int best_vehicle_id = columns.vehicle_ids[column];
+		for (int i = ties.start[column]; i < ties.start[column + 1]; i++) {
+			int vehicle_id = ties.vehicle_ids[i];
+			if (solution.vehicle_tours[vehicle_id].size() < solution.vehicle_tours[best_vehicle_id].size()) {
+				best_vehicle_id = vehicle_id;
+			}
+		}
+		solution.vehicle_tours[best_vehicle_id].push_back(column);
+	}
+
+	for (std::vector<int>& tours : solution.vehicle_tours) {
+		std::sort(tours.begin(), tours.end());
+	}
+}
+
+/*
+ * Decode the accepted bids of an optimized model using a single bulk query of all variable values
+ * @param model - Optimized GRB model
+ * @param columns - Column arrays (maps each column to its vehicle and targets)
+ * @param bid_vars - Variable of each column
+ * @param num_vehicles - Number of vehicles
+ * @param solution - Output: decoded solution
+ */
+void decode_solution(GRBModel& model, const BidColumns& columns, const std::vector<GRBVar>& bid_vars, int num_vehicles, CvrpSolution& solution) {
+	int num_columns = bid_vars.size();
+	solution.objective = model.get(GRB_DoubleAttr_ObjVal);
+	solution.bound = model.get(GRB_IntAttr_IsMIP) ? model.get(GRB_DoubleAttr_ObjBound) : solution.objective;
+	solution.stopped_at_deadline = model.get(GRB_IntAttr_Status) == GRB_TIME_LIMIT;
+	solution.accepted_columns.clear();
+	solution.vehicle_tours.assign(num_vehicles, std::vector<int>());
+
+	double* values = model.get(GRB_DoubleAttr_X, bid_vars.data(), num_columns);
+	for (int column = 0; column < num_columns; column++) {
+		// Bid has been "accepted by auctioneer"
+		if (values[column] > 0.5) {
+			solution.accepted_columns.push_back(column);
+			solution.vehicle_tours[columns.vehicle_ids[column]].push_back(column);
+		}
+	}
+
+	delete[] values;
+}
+
+/*
+ * Build a solution from a set of selected columns (e.g. a heuristic cover)
+ * @param columns - Column arrays (maps each column to its vehicle)
+ * @param selected - Whether each column is selected
+ * @param num_vehicles - Number of vehicles
+ * @param solution - Output: solution of the selected columns (its bound is left to the caller)
+ */
+void decode_selected_columns(const BidColumns& columns, const std::vector<char>& selected, int num_vehicles, CvrpSolution& solution) {
+	solution.objective = 0;
+	solution.accepted_columns.clear();
+	solution.vehicle_tours.assign(num_vehicles, std::vector<int>());
+	for (int column = 0; column < (int) selected.size(); column++) {
+		if (selected[column]) {
+			solution.objective += columns.tour_lengths[column];
+			solution.accepted_columns.push_back(column);
+			solution.vehicle_tours[columns.vehicle_ids[column]].push_back(column);
+		}
+	}
+}
+
+/*
+ * Return a lower bound on any exact cover of the coverable targets: each column's tour length is shared evenly
+ * among its targets, and every target is charged its cheapest share
+ * @param columns - Column arrays and cover rows
+ */
+double column_share_bound(const BidColumns& columns) {
+	double bound = 0;
+	int num_targets = (int) columns.cover_row_start.size() - 1;
+	for (int target_id = 0; target_id < num_targets; target_id++) {
+		double cheapest_share = -1;
+		for (int i = columns.cover_row_start[target_id]; i < columns.cover_row_start[target_id + 1]; i++) {
+			int column = columns.cover_row_bids[i];
+			int num_column_targets = 1 + (columns.target_ids_2[column] != -1) + (columns.target_ids_3[column] != -1);
+			double share = columns.tour_lengths[column] / num_column_targets;
+			if (cheapest_share < 0 || share < cheapest_share) {
+				cheapest_share = share;
+			}
+		}
+		bound += std::max(0.0, cheapest_share);
+	}
+	return bound;
+}
+
+/*
+ * Return the relative gap between a solution and its lower bound (0 when solved exactly)
+ * @param solution - Solution
+ */
+double solution_gap(const CvrpSolution& solution) {
+	return solution.objective > 0 ? std::max(0.0, solution.objective - solution.bound) / solution.objective : 0;
+}
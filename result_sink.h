@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Result encodings and a buffered result sink
+ * A solved instance is described by a ResultRecord and encoded as
+ *   text         the legacy results file format (instance name, minimum sum of tour lengths, vehicles and tours; the
+ *                lower bound and gap only for solves stopped at a deadline)
+ *   JSON lines   one JSON object per instance
+ *   binary       length-prefixed records after a "CVRPRES2" file magic:
+ *                uint32 record length (excluding itself), uint32 name length, name bytes, float64 objective,
+ *                float64 solve seconds, float64 lower bound, uint32 flags (bit 0 = stopped at a deadline),
+ *                uint32 number of uncovered targets, int32 target IDs,
+ *                uint32 number of tours, then per tour uint32 vehicle ID, uint32 number of targets, int32 target IDs
+ * A sink opens its file once (appending) and writes through a large buffer.
+ */
+
+enum ResultEncoding {
+	RESULT_ENCODING_TEXT,
+	RESULT_ENCODING_JSON_LINES,
+	RESULT_ENCODING_BINARY
+};
+
+struct ResultRecord {
+	std::string							instance_name;
+	double								objective;
+	double								solve_seconds;
+	double								bound;					// Lower bound on the objective
+	bool								stopped_at_deadline;	// Best incumbent at a deadline rather than a proven optimum
+	std::vector<std::pair<int, int>>	target_locations;		// Indexed by target ID
+	std::vector<std::pair<int, int>>	vehicle_locations;		// Indexed by vehicle ID
+	std::vector<int>					vehicle_order;			// Vehicles in output order
+	std::vector<int>					uncovered_targets;
+	std::vector<std::vector<std::vector<int>>>	vehicle_tours;	// Target IDs of each tour of each vehicle (by vehicle ID)
+};
+
+struct ResultSink {
+	FILE*				file = NULL;
+	ResultEncoding		encoding = RESULT_ENCODING_TEXT;
+	std::vector<char>	buffer;
+};
+
+const char		RESULT_BINARY_MAGIC[8] = {'C', 'V', 'R', 'P', 'R', 'E', 'S', '2'};
+const size_t	RESULT_SINK_BUFFER_SIZE = 1 << 20;
+
+/*
+ * Return the relative gap of a result to its lower bound
+ * @param record - Result record
+ */
+double result_gap(const ResultRecord& record) {
+	return record.objective > 0 ? std::max(0.0, record.objective - record.bound) / record.objective : 0;
+}
+
+/*
+ * Encode a result in the legacy text format
+ * @param record - Result record
+ * @param bytes - Output: encoded result
+ */
+void encode_text_result(const ResultRecord& record, std::string& bytes) {
+	std::ostringstream outfile;
+
+	// Write instance name
+	outfile << record.instance_name << "\n";
+
+	// Write minimum sum of tour lengths
+	outfile << "Minimum Sum of Tour Lengths: " << record.objective << "\n";
+
+	// Write the bound and gap of a solve stopped at its deadline
+	if (record.stopped_at_deadline) {
+		outfile << "Stopped at Deadline: Lower Bound " << record.bound << ", Gap " << 100 * result_gap(record) << "%\n";
+	}
+
+	// Write targets that could not be serviced, if any
+	if (!record.uncovered_targets.empty()) {
+		outfile << "Uncoverable Targets: ";
+		for (size_t i = 0; i < record.uncovered_targets.size(); i++) {
+			const std::pair<int, int>& location = record.target_locations[record.uncovered_targets[i]];
+			outfile << (i > 0 ? ";" : "") << location.first << "," << location.second;
+		}
+		outfile << "\n";
+	}
+
+	// Track assignments of targets to vehicles
+	for (int vehicle_id : record.vehicle_order) {
+		// Write vehicle information
+		const std::pair<int, int>& depot_location = record.vehicle_locations[vehicle_id];
+		outfile << "Vehicle: " << depot_location.first << "," << depot_location.second << "\n";
+
+		// Output tour count and target locations
+		int tour_count = 1;
+		for (const std::vector<int>& tour : record.vehicle_tours[vehicle_id]) {
+			outfile << "Tour " << tour_count++ << ": ";
+			for (size_t i = 0; i < tour.size(); i++) {
+				const std::pair<int, int>& location = record.target_locations[tour[i]];
+				outfile << (i > 0 ? ";" : "") << location.first << "," << location.second;
+			}
+			outfile << "\n";
+		}
+
+		outfile << "\n";
+	}
+
+	bytes = outfile.str();
+}
+
+/*
+ * Encode a result as one JSON line
+ * @param record - Result record
+ * @param bytes - Output: encoded result
+ */
+void encode_json_result(const ResultRecord& record, std::string& bytes) {
+	std::ostringstream outfile;
+	outfile.precision(17);
+
+	// Instance name as a JSON string
+	outfile << "{\"instance\":\"";
+	for (unsigned char character : record.instance_name) {
+		if (character == '"' || character == '\\') {
+			outfile << '\\' << character;
+		} else if (character < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+			outfile << escaped;
+		} else {
+			outfile << character;
+		}
+	}
+
+	outfile << "\",\"objective\":" << record.objective << ",\"solve_seconds\":" << record.solve_seconds << ",\"bound\":" << record.bound
+			<< ",\"gap\":" << result_gap(record) << ",\"stopped_at_deadline\":" << (record.stopped_at_deadline ? "true" : "false")
+			<< ",\"uncovered_targets\":[";
+	for (size_t i = 0; i < record.uncovered_targets.size(); i++) {
+		outfile << (i > 0 ? "," : "") << record.uncovered_targets[i];
+	}
+
+	outfile << "],\"tours\":[";
+	bool first_tour = true;
+	for (int vehicle_id : record.vehicle_order) {
+		for (const std::vector<int>& tour : record.vehicle_tours[vehicle_id]) {
+			outfile << (first_tour ? "" : ",") << "{\"vehicle\":" << vehicle_id << ",\"targets\":[";
+			for (size_t i = 0; i < tour.size(); i++) {
+				outfile << (i > 0 ? "," : "") << tour[i];
+			}
+			outfile << "]}";
+			first_tour = false;
+		}
+	}
+	outfile << "]}\n";
+
+	bytes = outfile.str();
+}
+
+/*
+ * Append raw bytes of a value to a binary record
+ */
+template <typename Value>
+void append_binary_value(std::string& bytes, Value value) {
+	bytes.append((const char*) &value, sizeof(value));
+}
+
+/*
+ * Encode a result as one binary record
+ * @param record - Result record
+ * @param bytes - Output: encoded result
+ */
+void encode_binary_result(const ResultRecord& record, std::string& bytes) {
+	bytes.clear();
+	append_binary_value<uint32_t>(bytes, 0);	// Record length, set below
+	append_binary_value<uint32_t>(bytes, record.instance_name.size());
+	bytes.append(record.instance_name);
+	append_binary_value<double>(bytes, record.objective);
+	append_binary_value<double>(bytes, record.solve_seconds);
+	append_binary_value<double>(bytes, record.bound);
+	append_binary_value<uint32_t>(bytes, record.stopped_at_deadline ? 1 : 0);
+
+	append_binary_value<uint32_t>(bytes, record.uncovered_targets.size());
+	for (int target_id : record.uncovered_targets) {
+		append_binary_value<int32_t>(bytes, target_id);
+	}
+
+	uint32_t num_tours = 0;
+	for (int vehicle_id : record.vehicle_order) {
+		num_tours += record.vehicle_tours[vehicle_id].size();
+	}
+	append_binary_value<uint32_t>(bytes, num_tours);
+	for (int vehicle_id : record.vehicle_order) {
+		for (const std::vector<int>& tour : record.vehicle_tours[vehicle_id]) {
+			append_binary_value<uint32_t>(bytes, vehicle_id);
+			append_binary_value<uint32_t>(bytes, tour.size());
+			for (int target_id : tour) {
+				append_binary_value<int32_t>(bytes, target_id);
+			}
+		}
+	}
+
+	uint32_t record_length = bytes.size() - sizeof(uint32_t);
+	memcpy(&bytes[0], &record_length, sizeof(record_length));
+}
+
+/*
+ * Encode a result
+ * @param record - Result record
+ * @param encoding - Result encoding
+ * @param bytes - Output: encoded result
+ */
+void encode_result(const ResultRecord& record, ResultEncoding encoding, std::string& bytes) {
+	if (encoding == RESULT_ENCODING_JSON_LINES) {
+		encode_json_result(record, bytes);
+	} else if (encoding == RESULT_ENCODING_BINARY) {
+		encode_binary_result(record, bytes);
+	} else {
+		encode_text_result(record, bytes);
+	}
+}
+
+/*
+ * Open a result sink appending to a file (a new binary results file starts with its magic)
+ * @param sink - Result sink
+ * @param file_name - Name of the results file
+ * @param encoding - Encoding of the results written to the sink
+ * @param buffer_size - Write buffer size
+ * Return false if the file could not be opened
+ */
+bool open_result_sink(ResultSink& sink, const std::string& file_name, ResultEncoding encoding, size_t buffer_size = RESULT_SINK_BUFFER_SIZE) {
+	sink.encoding = encoding;
+	sink.file = fopen(file_name.c_str(), encoding == RESULT_ENCODING_BINARY ? "ab" : "a");	// Append to file rather than overwrite
+	if (sink.file == NULL) {
+		return false;
+	}
+
+	sink.buffer.resize(buffer_size);
+	setvbuf(sink.file, sink.buffer.data(), _IOFBF, sink.buffer.size());
+	if (encoding == RESULT_ENCODING_BINARY) {
+		fseek(sink.file, 0, SEEK_END);
+		if (ftell(sink.file) == 0) {
+			fwrite(RESULT_BINARY_MAGIC, 1, sizeof(RESULT_BINARY_MAGIC), sink.file);
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Write an encoded result to a sink
+ * @param sink - Open result sink
+ * @param bytes - Result encoded with the sink's encoding
+ */
+void write_result(ResultSink& sink, const std::string& bytes) {
+	if (sink.file != NULL) {
+		fwrite(bytes.data(), 1, bytes.size(), sink.file);
+	}
+}
+
+/*
+ * Flush and close a result sink
+ * @param sink - Result sink
+ */
+void close_result_sink(ResultSink& sink) {
+	if (sink.file != NULL) {
+		fclose(sink.file);
+	}
+	sink.file = NULL;
+	std::vector<char>().swap(sink.buffer);
+}
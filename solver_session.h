@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdio.h>
+#include <string>
+#include "gurobi_c++.h"
+
+/*
+ * Long-lived Gurobi session shared by every instance and pipeline stage
+ * The environment (and its license checkout) is started once, on the first model, and kept until the session is
+ * closed. Parameters are set on the environment, so every model handed out afterwards inherits them. Sessions that
+ * never create a model (e.g. the matching backend) never start Gurobi.
+ * A solve deadline (an absolute point in time, e.g. the end of an instance's or a batch's time budget) caps the time
+ * limit of the models optimized before it.
+ */
+
+struct SolverParameters {
+	int		threads = 0;			// Solver threads (0 = solver default)
+	double	time_limit = 0;			// Seconds per optimize call (0 = no limit)
+	double	mip_gap = -1;			// Relative MIP gap (negative = solver default)
+	double	mip_gap_abs = -1;		// Absolute MIP gap (negative = solver default)
+	int		seed = -1;				// Random seed (negative = solver default)
+	bool	output = false;			// Solver log output
+};
+
+struct SolverSessionStats {
+	int		environments_started = 0;
+	double	environment_seconds = 0;	// Environment startup (paid once per session)
+	int		models_created = 0;
+	double	model_setup_seconds = 0;	// Creating empty models from the environment
+	int		optimize_calls = 0;
+	double	optimize_seconds = 0;
+};
+
+struct SolveDeadline {
+	bool									active = false;
+	std::chrono::steady_clock::time_point	time;
+};
+
+struct SolverSession {
+	GRBEnv*				environment = NULL;		// Started on the first model
+	SolverParameters	parameters;
+	SolverSessionStats	stats;
+};
+
+/*
+ * Apply the session parameters to its environment (models created afterwards inherit them)
+ * @param session - Solver session with a started environment
+ */
+void apply_session_parameters(SolverSession& session) {
+	GRBEnv& environment = *session.environment;
+	environment.set(GRB_IntParam_OutputFlag, session.parameters.output ? 1 : 0);
+	environment.set(GRB_IntParam_Threads, session.parameters.threads);
+	environment.set(GRB_DoubleParam_TimeLimit, session.parameters.time_limit > 0 ? session.parameters.time_limit : GRB_INFINITY);
+	if (session.parameters.mip_gap >= 0) {
+		environment.set(GRB_DoubleParam_MIPGap, session.parameters.mip_gap);
+	}
+	if (session.parameters.mip_gap_abs >= 0) {
+		environment.set(GRB_DoubleParam_MIPGapAbs, session.parameters.mip_gap_abs);
+	}
+	if (session.parameters.seed >= 0) {
+		environment.set(GRB_IntParam_Seed, session.parameters.seed);
+	}
+}
+
+/*
+ * Change the parameters of a session (applied to the models created afterwards)
+ * @param session - Solver session
+ * @param parameters - New parameters
+ */
+void set_session_parameters(SolverSession& session, const SolverParameters& parameters) {
+	session.parameters = parameters;
+	if (session.environment != NULL) {
+		apply_session_parameters(session);
+	}
+}
+
+/*
+ * Return the environment of a session, starting it on first use
+ * @param session - Solver session
+ */
+GRBEnv& session_environment(SolverSession& session) {
+	if (session.environment == NULL) {
+		auto start = std::chrono::steady_clock::now();
+		session.environment = new GRBEnv();
+		apply_session_parameters(session);
+		session.stats.environments_started++;
+		session.stats.environment_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	return *session.environment;
+}
+
+/*
+ * Return a new empty model of the session
+ * @param session - Solver session
+ * @param model_name - Model name (empty for none)
+ */
+GRBModel session_model(SolverSession& session, std::string model_name) {
+	GRBEnv& environment = session_environment(session);
+	auto start = std::chrono::steady_clock::now();
+	GRBModel model = GRBModel(environment);
+	if (!model_name.empty()) {
+		model.set(GRB_StringAttr_ModelName, model_name);
+	}
+	session.stats.models_created++;
+	session.stats.model_setup_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return model;
+}
+
+/*
+ * Optimize a model of the session, recording the solve time
+ * @param session - Solver session
+ * @param model - Model created by session_model
+ */
+void optimize_in_session(SolverSession& session, GRBModel& model) {
+	auto start = std::chrono::steady_clock::now();
+	model.optimize();
+	session.stats.optimize_calls++;
+	session.stats.optimize_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Return the deadline a number of seconds from now
+ * @param seconds - Time budget (0 or negative = no deadline)
+ */
+SolveDeadline deadline_after(double seconds) {
+	SolveDeadline deadline;
+	if (seconds > 0) {
+		deadline.active = true;
+		deadline.time = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+	}
+	return deadline;
+}
+
+/*
+ * Return the earlier of two deadlines
+ * @param deadline_1, deadline_2 - Deadlines (inactive ones never come first)
+ */
+SolveDeadline earlier_deadline(const SolveDeadline& deadline_1, const SolveDeadline& deadline_2) {
+	if (!deadline_1.active || (deadline_2.active && deadline_2.time < deadline_1.time)) {
+		return deadline_2;
+	}
+	return deadline_1;
+}
+
+/*
+ * Return the seconds left until a deadline (negative once it has passed, infinity for an inactive deadline)
+ * @param deadline - Deadline
+ */
+double seconds_remaining(const SolveDeadline& deadline) {
+	if (!deadline.active) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return std::chrono::duration<double>(deadline.time - std::chrono::steady_clock::now()).count();
+}
+
+/*
+ * Cap the time limit of a model of the session at a deadline (the session's own time limit still applies)
+ * @param session - Solver session
+ * @param model - Model created by session_model
+ * @param deadline - Deadline of the solve
+ */
+void set_model_deadline(SolverSession& session, GRBModel& model, const SolveDeadline& deadline) {
+	if (deadline.active) {
+		double time_limit = std::max(0.0, seconds_remaining(deadline));
+		if (session.parameters.time_limit > 0) {
+			time_limit = std::min(time_limit, session.parameters.time_limit);
+		}
+		model.set(GRB_DoubleParam_TimeLimit, time_limit);
+	}
+}
+
+/*
+ * Add the statistics of one session to a total
+ * @param total - Statistics to add to
+ * @param stats - Statistics of a session
+ */
+void add_session_stats(SolverSessionStats& total, const SolverSessionStats& stats) {
+	total.environments_started += stats.environments_started;
+	total.environment_seconds += stats.environment_seconds;
+	total.models_created += stats.models_created;
+	total.model_setup_seconds += stats.model_setup_seconds;
+	total.optimize_calls += stats.optimize_calls;
+	total.optimize_seconds += stats.optimize_seconds;
+}
+
+/*
+ * Print the per-instance solver overhead of a batch
+ * @param after - Session statistics at the end of the batch
+ * @param before - Session statistics at the start of the batch
+ * @param num_instances - Number of instances in the batch
+ */
+void print_session_overhead(const SolverSessionStats& after, const SolverSessionStats& before, int num_instances) {
+	if (num_instances == 0 || after.models_created == before.models_created) {
+		return;
+	}
+
+	int environments_started = after.environments_started - before.environments_started;
+	double environment_seconds = after.environment_seconds - before.environment_seconds;
+	double setup_seconds = after.model_setup_seconds - before.model_setup_seconds;
+	double optimize_seconds = after.optimize_seconds - before.optimize_seconds;
+	double seconds_per_environment = after.environments_started > 0 ? after.environment_seconds / after.environments_started : 0;
+	printf("Solver session: %d instances, %d environment(s) started in %.3f s (one environment per instance would pay ~%.3f s), "
+		   "model setup %.3f ms/instance, optimize %.3f ms/instance\n", num_instances, environments_started, environment_seconds,
+		   seconds_per_environment * num_instances, 1e3 * setup_seconds / num_instances, 1e3 * optimize_seconds / num_instances);
+}
+
+/*
+ * Close a session, freeing its environment (a later model starts a new one)
+ * @param session - Solver session
+ */
+void close_solver_session(SolverSession& session) {
+	delete session.environment;
+	session.environment = NULL;
+}
@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/*
+ * Uniform-grid spatial index over integer points (built once per instance, e.g. over the vehicle depots in slot order)
+ * Points are bucketed into square cells; queries visit rings of cells around the query cell in order of increasing
+ * Chebyshev ring and stop as soon as the distance lower bound of the next ring exceeds the best result found.
+ * Nearest-point queries compare exact integer squared distances, so ties are detected exactly; ties are reported
+ * in ascending point index order.
+ */
+
+struct SpatialGrid {
+	double								min_x;
+	double								min_y;
+	double								cell_size;
+	int									cells_x;
+	int									cells_y;
+	std::vector<int>					cell_start;		// Points of cell c are cell_points[cell_start[c], cell_start[c + 1])
+	std::vector<int>					cell_points;	// Point indices, ascending within each cell
+	std::vector<std::pair<int, int>>	points;
+};
+
+// Target average number of points per grid cell
+const int SPATIAL_GRID_POINTS_PER_CELL = 2;
+
+/*
+ * Return squared Euclidean distance between two integer points
+ * @param location1, location2 - The coordinate pairs to measure the distance between
+ */
+long long squared_distance(std::pair<int, int> location1, std::pair<int, int> location2) {
+	long long x_dist = location1.first - location2.first;
+	long long y_dist = location1.second - location2.second;
+	return x_dist * x_dist + y_dist * y_dist;
+}
+
+/*
+ * Build a uniform grid over a set of points
+ * @param grid - Grid to populate
+ * @param points - Point coordinates (indexed by point index, e.g. vehicle slot)
+ */
+void build_spatial_grid(SpatialGrid& grid, const std::vector<std::pair<int, int>>& points) {
+	grid.points = points;
+	int num_points = points.size();
+	int min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+
+	for (int i = 0; i < num_points; i++) {
+		if (i == 0 || points[i].first < min_x) min_x = points[i].first;
+		if (i == 0 || points[i].first > max_x) max_x = points[i].first;
+		if (i == 0 || points[i].second < min_y) min_y = points[i].second;
+		if (i == 0 || points[i].second > max_y) max_y = points[i].second;
+	}
+
+	// Square cells sized so that each holds SPATIAL_GRID_POINTS_PER_CELL points on average
+	double width = max_x - min_x + 1.0;
+	double height = max_y - min_y + 1.0;
+	double num_cells = std::max(1.0, (double) num_points / SPATIAL_GRID_POINTS_PER_CELL);
+	grid.cell_size = std::max(1.0, std::sqrt(width * height / num_cells));
+	grid.min_x = min_x;
+	grid.min_y = min_y;
+	grid.cells_x = (int) (width / grid.cell_size) + 1;
+	grid.cells_y = (int) (height / grid.cell_size) + 1;
+
+	// Bucket points into cells (counting sort keeps indices ascending within each cell)
+	std::vector<int> point_cells(num_points);
+	grid.cell_start.assign((size_t) grid.cells_x * grid.cells_y + 1, 0);
+	for (int i = 0; i < num_points; i++) {
+		int cell_x = (int) ((points[i].first - grid.min_x) / grid.cell_size);
+		int cell_y = (int) ((points[i].second - grid.min_y) / grid.cell_size);
+		point_cells[i] = cell_y * grid.cells_x + cell_x;
+		grid.cell_start[point_cells[i] + 1]++;
+	}
+
+	for (size_t cell = 0; cell + 1 < grid.cell_start.size(); cell++) {
+		grid.cell_start[cell + 1] += grid.cell_start[cell];
+	}
+
+	grid.cell_points.resize(num_points);
+	std::vector<int> cell_fill(grid.cell_start.begin(), grid.cell_start.end() - 1);
+	for (int i = 0; i < num_points; i++) {
+		grid.cell_points[cell_fill[point_cells[i]]++] = i;
+	}
+}
+
+/*
+ * Visit grid points ring by ring around a query location
+ * @param grid - Spatial grid
+ * @param x, y - Query location
+ * @param search_done - Called before each ring with a lower bound on the distance from the query to any point of that
+ *                      ring (and of every later ring); the search stops when it returns true
+ * @param visit_point - Called with the index of each point of the ring
+ */
+template <typename SearchDone, typename VisitPoint>
+void search_grid_rings(const SpatialGrid& grid, double x, double y, SearchDone search_done, VisitPoint visit_point) {
+	// Query cell (may lie outside the grid)
+	int query_x = (int) std::floor((x - grid.min_x) / grid.cell_size);
+	int query_y = (int) std::floor((y - grid.min_y) / grid.cell_size);
+	int max_ring = std::max(std::max(std::abs(query_x), std::abs(grid.cells_x - 1 - query_x)),
+							std::max(std::abs(query_y), std::abs(grid.cells_y - 1 - query_y)));
+
+	for (int ring = 0; ring <= max_ring; ring++) {
+		// Distance from the query to the outside of the square of rings 0..ring-1
+		double lower_bound = 0;
+		if (ring > 0) {
+			double left = grid.min_x + (query_x - ring + 1) * grid.cell_size;
+			double right = grid.min_x + (query_x + ring) * grid.cell_size;
+			double bottom = grid.min_y + (query_y - ring + 1) * grid.cell_size;
+			double top = grid.min_y + (query_y + ring) * grid.cell_size;
+			lower_bound = std::max(0.0, std::min(std::min(x - left, right - x), std::min(y - bottom, top - y)));
+		}
+
+		if (search_done(lower_bound)) {
+			return;
+		}
+
+		for (int cell_y = std::max(0, query_y - ring); cell_y <= std::min(grid.cells_y - 1, query_y + ring); cell_y++) {
+			// Interior rows of the ring only contribute their two end cells
+			bool full_row = cell_y == query_y - ring || cell_y == query_y + ring;
+			int step = full_row ? 1 : 2 * ring;
+
+			for (int cell_x = query_x - ring; cell_x <= query_x + ring; cell_x += std::max(1, step)) {
+				if (cell_x < 0 || cell_x >= grid.cells_x) {
+					continue;
+				}
+
+				int cell = cell_y * grid.cells_x + cell_x;
+				for (int i = grid.cell_start[cell]; i < grid.cell_start[cell + 1]; i++) {
+					visit_point(grid.cell_points[i]);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Return the k points nearest to a location, by distance then point index
+ * @param grid - Spatial grid
+ * @param location - Query location
+ * @param k - Number of points to return (fewer if the grid holds fewer points)
+ * @param nearest_points - Output: point indices, nearest first
+ */
+void grid_nearest_k(const SpatialGrid& grid, std::pair<int, int> location, int k, std::vector<int>& nearest_points) {
+	std::vector<std::pair<long long, int>> candidates;
+	nearest_points.clear();
+	if (k <= 0) {
+		return;
+	}
+
+	// Max-heap of the k best (squared distance, point index) pairs found so far
+	search_grid_rings(grid, location.first, location.second, [&](double lower_bound) {
+		return candidates.size() == (size_t) k && lower_bound * lower_bound > candidates.front().first;
+	}, [&](int point) {
+		std::pair<long long, int> candidate(squared_distance(location, grid.points[point]), point);
+		if (candidates.size() < (size_t) k) {
+			candidates.push_back(candidate);
+			std::push_heap(candidates.begin(), candidates.end());
+		} else if (candidate < candidates.front()) {
+			std::pop_heap(candidates.begin(), candidates.end());
+			candidates.back() = candidate;
+			std::push_heap(candidates.begin(), candidates.end());
+		}
+	});
+
+	std::sort_heap(candidates.begin(), candidates.end());
+	for (const auto& candidate : candidates) {
+		nearest_points.push_back(candidate.second);
+	}
+}
+
+/*
+ * Return all points tied at the minimum distance from a location, considering only points with index < point_limit
+ * @param grid - Spatial grid
+ * @param location - Query location
+ * @param point_limit - Points with index >= point_limit are ignored (e.g. vehicles unable to carry the target)
+ * @param nearest_points - Output: tied point indices, ascending
+ * Return the minimum squared distance (-1 if no point qualifies)
+ */
+long long grid_nearest_ties(const SpatialGrid& grid, std::pair<int, int> location, int point_limit, std::vector<int>& nearest_points) {
+	long long min_squared_distance = -1;
+	nearest_points.clear();
+
+	search_grid_rings(grid, location.first, location.second, [&](double lower_bound) {
+		return min_squared_distance != -1 && lower_bound * lower_bound > min_squared_distance;
+	}, [&](int point) {
+		if (point >= point_limit) {
+			return;
+		}
+
+		long long point_squared_distance = squared_distance(location, grid.points[point]);
+		if (point_squared_distance < min_squared_distance || min_squared_distance == -1) {
+			nearest_points.clear();
+			nearest_points.push_back(point);
+			min_squared_distance = point_squared_distance;
+		} else if (point_squared_distance == min_squared_distance) {
+			nearest_points.push_back(point);
+		}
+	});
+
+	std::sort(nearest_points.begin(), nearest_points.end());
+	return min_squared_distance;
+}
+
+/*
+ * Return the expected number of points a ring search visits before reaching a given radius
+ * (assumes points are spread evenly over the grid, at SPATIAL_GRID_POINTS_PER_CELL per cell)
+ * @param grid - Spatial grid
+ * @param radius - Search radius
+ */
+double grid_expected_points_within(const SpatialGrid& grid, double radius) {
+	// Rings are visited whole, so the search covers about one extra cell beyond the radius
+	double radius_cells = radius / grid.cell_size + 1.5;
+	return std::min((double) grid.points.size(), SPATIAL_GRID_POINTS_PER_CELL * M_PI * radius_cells * radius_cells);
+}
+
+/*
+ * Best-vehicle selection for a pair bid using the depot grid (same contract as best_pair_vehicles)
+ * Depots are searched around the midpoint m of the two targets: for any depot v, d(t1,v) + d(t2,v) >= 2 d(m,v), so
+ * once twice the ring lower bound exceeds the best tour length no remaining depot can match it. Tour lengths are
+ * read from the same distance rows as the kernel, so costs and ties are bit-identical.
+ * @param grid - Spatial grid over the depots (point index = vehicle slot)
+ * @param location_1, location_2 - Target locations
+ * @param depot_distances_1, depot_distances_2 - Depot distance rows of the two targets (indexed by vehicle slot)
+ * @param targets_distance - Distance between the two targets
+ * @param num_vehicles - Only vehicle slots below num_vehicles are considered (must be positive)
+ * @param best_vehicle_slots - Output: all vehicle slots attaining the minimum tour length (ascending)
+ * Return the minimum tour length
+ */
+double best_pair_vehicles_grid(const SpatialGrid& grid, std::pair<int, int> location_1, std::pair<int, int> location_2,
+							   const double* depot_distances_1, const double* depot_distances_2, double targets_distance,
+							   int num_vehicles, std::vector<int>& best_vehicle_slots) {
+	double min_tour_length = -1;
+	best_vehicle_slots.clear();
+
+	double midpoint_x = 0.5 * (location_1.first + location_2.first);
+	double midpoint_y = 0.5 * (location_1.second + location_2.second);
+
+	search_grid_rings(grid, midpoint_x, midpoint_y, [&](double lower_bound) {
+		// Small slack so that rounding in the tour lengths can never cut off a tie
+		return min_tour_length != -1 && targets_distance + 2.0 * lower_bound > min_tour_length * (1 + 1e-12) + 1e-9;
+	}, [&](int slot) {
+		if (slot >= num_vehicles) {
+			return;
+		}
+
+		double tour_length = targets_distance + depot_distances_1[slot] + depot_distances_2[slot];
+		if (tour_length < min_tour_length || min_tour_length == -1) {
+			best_vehicle_slots.clear();
+			best_vehicle_slots.push_back(slot);
+			min_tour_length = tour_length;
+		} else if (tour_length == min_tour_length) {
+			best_vehicle_slots.push_back(slot);
+		}
+	});
+
+	std::sort(best_vehicle_slots.begin(), best_vehicle_slots.end());
+	return min_tour_length;
+}
@@ -0,0 +1,348 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dataset_parser.h"
+#include "live_instance.h"
+#include "result_sink.h"
+
+/*
+ * Rolling-horizon streaming driver
+ * Events are read from a file (or stdin) in timestamp order, one per line ('#' starts a comment line):
+ *   <time> V <x> <y> <capacity>      vehicle with its current position (all vehicles come before any other event)
+ *   <time> T <x> <y> <weight>        target arrival (targets are numbered 0, 1, ... in arrival order)
+ *   <time> C <target>                cancellation of a target not yet committed
+ *   <time> M <vehicle> <x> <y>       vehicle position update
+ *   <time> D <vehicle>, E <vehicle>  vehicle off duty / back on duty
+ * Arrivals are batched into decision epochs that end after an amount of stream time, a number of arrivals, or both.
+ * At the end of each epoch the live instance (every target not yet committed, the vehicles at their current
+ * positions) is re-solved from the previous epoch's solution. Tours holding a target that has waited at least the
+ * commit wait are committed and written out; the other targets are carried into the next epoch, where they may pair
+ * with new arrivals. The end of the stream commits everything left.
+ */
+
+struct StreamOptions {
+	double			epoch_length = 0;		// Stream time per epoch (0 = epochs are not timed)
+	int				epoch_arrivals = 0;		// Arrivals per epoch (0 = epochs are not counted)
+	double			commit_wait = 0;		// Commit tours holding a target that has waited this long (0 = commit every tour each epoch)
+	std::string		output_file_name;		// Committed tours of each epoch (empty for none)
+	ResultEncoding	encoding = RESULT_ENCODING_TEXT;
+};
+
+struct StreamEvent {
+	double				time;
+	char				type;			// V, T, C, M, D or E
+	int					id;				// Target (C) or vehicle (M, D, E) ID
+	std::pair<int, int>	location;		// V, T, M
+	int					amount;			// Capacity (V) or weight (T)
+};
+
+struct EpochStats {
+	int		epoch;
+	double	end_time;				// Stream time the epoch ended at
+	int		arrivals;
+	int		carried_in;				// Targets carried over from earlier epochs
+	int		committed_targets;
+	int		committed_tours;
+	int		dropped_targets;		// Targets no vehicle can carry
+	int		carried_forward;
+	double	committed_length;		// Tour sum of the committed tours
+	double	latency_seconds;		// Re-solve and commit time
+};
+
+// Removed targets a live instance may hold before the stream compacts it (at least as many as its active targets)
+const int STREAM_COMPACT_MIN_REMOVED = 256;
+
+/*
+ * Read the next event of a stream
+ * @param in - Event stream
+ * @param stream_name - Name of the stream (for errors)
+ * @param line_number - Line number of the last line read (advanced)
+ * @param event - Output: event
+ * Return false at the end of the stream; throws a DatasetFormatError for a malformed line
+ */
+bool read_stream_event(std::istream& in, const std::string& stream_name, int& line_number, StreamEvent& event) {
+	std::string line;
+	while (std::getline(in, line)) {
+		line_number++;
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#') {
+			continue;
+		}
+
+		std::istringstream fields(line);
+		std::string type;
+		event = StreamEvent();
+		bool valid = (bool) (fields >> event.time >> type) && type.size() == 1;
+		event.type = valid ? type[0] : 0;
+		if (event.type == 'V' || event.type == 'T') {
+			valid = valid && (bool) (fields >> event.location.first >> event.location.second >> event.amount) && event.amount >= 0;
+		} else if (event.type == 'M') {
+			valid = valid && (bool) (fields >> event.id >> event.location.first >> event.location.second);
+		} else if (event.type == 'C' || event.type == 'D' || event.type == 'E') {
+			valid = valid && (bool) (fields >> event.id);
+		} else {
+			valid = false;
+		}
+
+		std::string rest;
+		if (!valid || (fields >> rest)) {
+			throw DatasetFormatError(stream_name, line_number, "malformed event \"" + line + "\"");
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Consume a stream of target arrival events in rolling-horizon epochs, committing tours as their targets come due
+ * @param input_file_name - Name of the event file ("-" for stdin)
+ * @param options - Epoch, commit and output options
+ */
+void stream_cvrp(std::string input_file_name, const StreamOptions& options) {
+	std::ifstream input_file;
+	std::istream* in = &std::cin;
+	std::string stream_name = input_file_name == "-" ? "stdin" : input_file_name;
+	if (input_file_name != "-") {
+		input_file.open(input_file_name);
+		if (!input_file) {
+			printf("Could not open event stream %s\n", input_file_name.c_str());
+			return;
+		}
+		in = &input_file;
+	}
+
+	ResultSink sink;
+	if (!options.output_file_name.empty()) {
+		open_result_sink(sink, options.output_file_name, options.encoding);
+	}
+
+	LiveInstance live;
+	live.solver.session.parameters = cvrp_solver.session.parameters;
+	live.log_updates = false;
+	const Instance& instance = live.solver.instance;
+
+	// Stream targets (by arrival number) and the live target each one currently is (-1 once committed, dropped or cancelled)
+	std::vector<double> arrival_times;
+	std::vector<std::pair<int, int>> arrival_locations;
+	std::vector<int> live_targets;
+	std::vector<int> stream_targets;		// Arrival number of each live target
+	int pending_targets = 0;
+	int cancelled_targets = 0;
+
+	std::vector<EpochStats> epochs;
+	EpochStats epoch = {};
+	double epoch_start = 0;
+	double update_seconds = 0;
+	bool started = false;
+	auto stream_start = std::chrono::steady_clock::now();
+
+	// Re-solve the live instance, commit the due tours and carry the other targets forward
+	auto close_epoch = [&](double end_time, bool commit_all) {
+		auto epoch_start_time = std::chrono::steady_clock::now();
+		CvrpSolution solution;
+		live_solve(live, solution);
+		if (solution.stopped_at_deadline) {
+			solver_log(live.solver, "Epoch %d stopped at its deadline: objective %f, bound %f, gap %.2f%%\n", epoch.epoch, solution.objective,
+					   solution.bound, 100 * solution_gap(solution));
+		}
+
+		// Committed tours, with targets numbered by arrival
+		ResultRecord record;
+		record.instance_name = "Epoch " + std::to_string(epoch.epoch) + " (t = " + std::to_string(end_time) + ")";
+		record.objective = 0;
+		record.stopped_at_deadline = false;
+		record.vehicle_locations.resize(vehicle_count(instance));
+		record.vehicle_tours.assign(vehicle_count(instance), std::vector<std::vector<int>>());
+		std::vector<int> committed_targets;
+		for (int vehicle_id = vehicle_count(instance) - 1; vehicle_id >= 0; vehicle_id--) {
+			record.vehicle_locations[vehicle_id] = vehicle_location(instance, vehicle_id);
+			record.vehicle_order.push_back(vehicle_id);
+			for (int column : solution.vehicle_tours[vehicle_id]) {
+				int target_ids[3];
+				int num_column_targets = column_targets(live.solver.bid_columns, column, target_ids);
+				bool due = commit_all || options.commit_wait <= 0;
+				for (int i = 0; i < num_column_targets && !due; i++) {
+					due = end_time - arrival_times[stream_targets[target_ids[i]]] >= options.commit_wait;
+				}
+				if (!due) {
+					continue;
+				}
+
+				std::vector<int> tour;
+				for (int i = 0; i < num_column_targets; i++) {
+					tour.push_back(stream_targets[target_ids[i]]);
+					committed_targets.push_back(target_ids[i]);
+				}
+				record.vehicle_tours[vehicle_id].push_back(tour);
+				record.objective += live.solver.bid_columns.tour_lengths[column];
+				epoch.committed_tours++;
+			}
+		}
+		for (int target_id : solution.uncovered_targets) {
+			record.uncovered_targets.push_back(stream_targets[target_id]);
+			committed_targets.push_back(target_id);
+		}
+		record.bound = record.objective;
+
+		// Committed and dropped targets leave the live instance
+		for (int target_id : committed_targets) {
+			live_remove_target(live, target_id);
+			live_targets[stream_targets[target_id]] = -1;
+		}
+		pending_targets -= committed_targets.size();
+		epoch.dropped_targets = solution.uncovered_targets.size();
+		epoch.committed_targets = committed_targets.size() - epoch.dropped_targets;
+		epoch.committed_length = record.objective;
+		epoch.carried_forward = pending_targets;
+		epoch.end_time = end_time;
+		epoch.latency_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_start_time).count();
+		record.solve_seconds = epoch.latency_seconds;
+
+		if (sink.file != NULL) {
+			// The record indexes target locations by arrival number (lent to it while encoding)
+			std::string bytes;
+			record.target_locations.swap(arrival_locations);
+			encode_result(record, options.encoding, bytes);
+			record.target_locations.swap(arrival_locations);
+			write_result(sink, bytes);
+		}
+
+		solver_log(live.solver, "Epoch %d (t = %g): %d arrivals, %d carried in, %d targets in %d tours committed (length %f), %d dropped, %d carried forward, %.3f ms\n",
+				   epoch.epoch, end_time, epoch.arrivals, epoch.carried_in, epoch.committed_targets, epoch.committed_tours, epoch.committed_length,
+				   epoch.dropped_targets, epoch.carried_forward, 1000 * epoch.latency_seconds);
+		epochs.push_back(epoch);
+
+		// Compact once removed targets outnumber the active ones
+		int removed_targets = target_count(instance) - pending_targets;
+		if (removed_targets >= std::max(STREAM_COMPACT_MIN_REMOVED, pending_targets)) {
+			std::vector<int> kept_targets;
+			compact_live_instance(live, kept_targets);
+			std::vector<int> compacted_stream_targets(kept_targets.size());
+			for (size_t target_id = 0; target_id < kept_targets.size(); target_id++) {
+				compacted_stream_targets[target_id] = stream_targets[kept_targets[target_id]];
+				live_targets[compacted_stream_targets[target_id]] = target_id;
+			}
+			stream_targets.swap(compacted_stream_targets);
+		}
+
+		EpochStats next_epoch = {};
+		next_epoch.epoch = epoch.epoch + 1;
+		next_epoch.carried_in = pending_targets;
+		epoch = next_epoch;
+	};
+
+	int line_number = 0;
+	double last_time = 0;
+	StreamEvent event;
+	try {
+		while (read_stream_event(*in, stream_name, line_number, event)) {
+			if (event.time < last_time) {
+				throw DatasetFormatError(stream_name, line_number, "event out of timestamp order");
+			}
+			last_time = event.time;
+
+			if (event.type == 'V') {
+				if (started) {
+					throw DatasetFormatError(stream_name, line_number, "vehicles must be declared before any other event");
+				}
+				add_vehicle(live.solver.instance, event.location, event.amount);
+				continue;
+			}
+
+			if (!started) {
+				start_live_instance(live);
+				started = true;
+				epoch_start = event.time;
+			}
+
+			// Timed epochs ending before this event (empty ones are skipped)
+			while (options.epoch_length > 0 && event.time >= epoch_start + options.epoch_length) {
+				if (pending_targets > 0) {
+					close_epoch(epoch_start + options.epoch_length, false);
+					epoch_start += options.epoch_length;
+				} else {
+					epoch_start += std::floor((event.time - epoch_start) / options.epoch_length) * options.epoch_length;
+				}
+			}
+
+			auto update_start = std::chrono::steady_clock::now();
+			bool valid_vehicle = event.id >= 0 && event.id < vehicle_count(instance);
+			if (event.type == 'T') {
+				live_targets.push_back(live_add_target(live, event.location, event.amount));
+				stream_targets.push_back(arrival_times.size());
+				arrival_times.push_back(event.time);
+				arrival_locations.push_back(event.location);
+				pending_targets++;
+				epoch.arrivals++;
+			} else if (event.type == 'C') {
+				if (event.id >= 0 && event.id < (int) live_targets.size() && live_targets[event.id] != -1) {
+					live_remove_target(live, live_targets[event.id]);
+					live_targets[event.id] = -1;
+					pending_targets--;
+					cancelled_targets++;
+				}
+			} else if (!valid_vehicle) {
+				throw DatasetFormatError(stream_name, line_number, "unknown vehicle " + std::to_string(event.id));
+			} else if (event.type == 'M') {
+				live_move_vehicle(live, event.id, event.location);
+			} else {
+				live_set_vehicle_enabled(live, event.id, event.type == 'E');
+			}
+			update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+
+			// Counted epochs
+			if (options.epoch_arrivals > 0 && epoch.arrivals >= options.epoch_arrivals) {
+				close_epoch(event.time, false);
+				epoch_start = event.time;
+			}
+		}
+
+		// The end of the stream commits everything left
+		if (!started) {
+			start_live_instance(live);
+		}
+		if (pending_targets > 0) {
+			close_epoch(last_time, true);
+		}
+	} catch (const DatasetFormatError& e) {
+		printf("%s\n", e.what());
+	} catch (GRBException e) {
+		printf("Error code = %d\n%s\n", e.getErrorCode(), e.getMessage().c_str());
+	}
+
+	close_result_sink(sink);
+	close_live_instance(live);
+	close_solver_session(live.solver.session);
+
+	// Latency and throughput
+	double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stream_start).count();
+	std::vector<double> latencies;
+	int committed_targets = 0;
+	int dropped_targets = 0;
+	double committed_length = 0;
+	for (const EpochStats& closed_epoch : epochs) {
+		latencies.push_back(closed_epoch.latency_seconds);
+		committed_targets += closed_epoch.committed_targets;
+		dropped_targets += closed_epoch.dropped_targets;
+		committed_length += closed_epoch.committed_length;
+	}
+	std::sort(latencies.begin(), latencies.end());
+	double mean_latency = 0;
+	for (double latency : latencies) {
+		mean_latency += latency / latencies.size();
+	}
+	double p95_latency = latencies.empty() ? 0 : latencies[std::min(latencies.size() - 1, (size_t) std::ceil(0.95 * latencies.size()) - 1)];
+
+	printf("Stream %s: %d epochs, %d arrivals, %d committed, %d cancelled, %d dropped, committed length %f\n", stream_name.c_str(),
+		   (int) epochs.size(), (int) arrival_times.size(), committed_targets, cancelled_targets, dropped_targets, committed_length);
+	printf("Epoch latency: mean %.3f ms, p95 %.3f ms, max %.3f ms; event updates %.3f ms in total; throughput %.0f targets/s (%.3f s wall)\n",
+		   1000 * mean_latency, 1000 * p95_latency, latencies.empty() ? 0 : 1000 * latencies.back(), 1000 * update_seconds,
+		   wall_seconds > 0 ? committed_targets / wall_seconds : 0, wall_seconds);
+}
@@ -27,6 +27,7 @@ int main(int argc, char *argv[]) {
     // Solve the WDP on CA instances
     std::string winners_file_name = "winners.txt";
     winner_determination(auctions_file_name, winners_file_name);
+    close_solver_session(auction_session);
 
     // Determine total distance travelled for each instance
     std::string results_file_name = "results.txt";
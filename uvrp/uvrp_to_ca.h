@@ -1,4 +1,5 @@
 #pragma once
+#include <climits>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -6,31 +7,18 @@
 #include <string>
 #include <string.h>
 #include <vector>
-
-struct Target {
-	std::pair<int, int> location;
-	int id;
-};
-
-struct Vehicle {
-	std::pair<int, int> depot_location;
-	int id;
-};
+#include "../distance_oracle.h"
+#include "../instance.h"
 
 int 						delivery_reward;
-std::vector<Target>			targets;
-std::vector<Vehicle>		vehicles;
-std::vector<int>			target_ids;
-std::vector<int>			vehicle_ids;
+Instance					uvrp_instance;		// Targets and vehicles of the current instance (uncapacitated: weights and capacities are 0)
+DistanceOracle				uvrp_distance_oracle;	// Offset distance table of the grid (kept across instances)
 
 /*
  * Reset instance state
  */
 void reset_uvrp_state() {
-	targets.clear();
-	vehicles.clear();
-	target_ids.clear();
-	vehicle_ids.clear();
+	clear_instance(uvrp_instance);
 }
 
 /*
@@ -61,7 +49,6 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
     // Parse target location data
     if (target_outfile.is_open()) {
 		target_outfile << dataset_name_line << std::endl;
-		int target_id = 0;
 		char *target_locations_save_pointer;
 		char* target_location = strtok_r(&target_locations_line[0], ";", &target_locations_save_pointer);
 
@@ -72,11 +59,7 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
 			target_location = strtok_r(NULL, ";", &target_locations_save_pointer);
 
 			// Instantiate target
-			Target new_target = {};
-			new_target.location = std::make_pair(x_coor, y_coor);
-			new_target.id = target_id++;
-			targets.push_back(new_target);
-			target_ids.push_back(new_target.id);
+			int new_target_id = add_target(uvrp_instance, std::make_pair(x_coor, y_coor), 0);
 
 			// Update coordinate extrema
 			min_x_coor = std::min(min_x_coor, x_coor);
@@ -85,7 +68,7 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
     		max_y_coor = std::max(max_y_coor, y_coor);
 
 			// Write target data to file
-			target_outfile << new_target.id << " " << x_coor << " " << y_coor << std::endl;
+			target_outfile << new_target_id << " " << x_coor << " " << y_coor << std::endl;
 		}
 
 		target_outfile << std::endl;
@@ -95,7 +78,6 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
 	// Parse vehicle location data
 	if (vehicle_outfile.is_open()) {
 		vehicle_outfile << dataset_name_line << std::endl;
-		int vehicle_id = 0;
 		char* vehicle_locations_save_pointer;
 		char* vehicle_location = strtok_r(&vehicle_locations_line[0], ";", &vehicle_locations_save_pointer);
 
@@ -106,11 +88,7 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
 			vehicle_location = strtok_r(NULL, ";", &vehicle_locations_save_pointer);
 
 			// Instantiate vehicle
-			Vehicle new_vehicle = {};
-			new_vehicle.depot_location = std::make_pair(x_coor, y_coor);
-			new_vehicle.id = vehicle_id++;
-			vehicles.push_back(new_vehicle);
-			vehicle_ids.push_back(new_vehicle.id);
+			int new_vehicle_id = add_vehicle(uvrp_instance, std::make_pair(x_coor, y_coor), 0);
 
 			// Update coordinate extrema
 			min_x_coor = std::min(min_x_coor, x_coor);
@@ -119,13 +97,16 @@ void handle_targets_vehicles(std::string dataset_name_line, std::string target_l
     		max_y_coor = std::max(max_y_coor, y_coor);
 
 			// Write vehicle data to file
-			vehicle_outfile << new_vehicle.id << " " << x_coor << " " << y_coor << std::endl;
+			vehicle_outfile << new_vehicle_id << " " << x_coor << " " << y_coor << std::endl;
 		}
 
 		vehicle_outfile << std::endl;
 		vehicle_outfile.close();
 	}
 
+	// Tabulate the distances of the instance's bounding box
+	cover_bounding_box(uvrp_distance_oracle, min_x_coor, min_y_coor, max_x_coor, max_y_coor);
+
 	// Calculate vehicle reward
 	delivery_reward = 2 * euclidean_distance(std::make_pair(min_x_coor, min_y_coor), std::make_pair(max_x_coor, max_y_coor));
 }
@@ -141,54 +122,54 @@ void create_bids(std::string dataset_name_line, std::string auctions_file_name)
     // Create bids
     if (auctions_outfile.is_open()) {
     	// Calculate number of goods and bids and write to file
-    	int num_goods = targets.size();
+    	const Instance& instance = uvrp_instance;
+    	const DistanceOracle& oracle = uvrp_distance_oracle;
+    	int num_goods = target_count(instance);
     	int num_bids = num_goods + 0.5 * num_goods * (num_goods - 1);
     	auctions_outfile << dataset_name_line << std::endl;
     	auctions_outfile << num_goods << " " << num_bids << std::endl;
 
 		// Iterate over all targets (for singleton bids)
-		for (const auto& target : targets) {
+		for (int target_id = 0; target_id < num_goods; target_id++) {
+			std::pair<int, int> location = target_location(instance, target_id);
 			int closest_vehicle_id = -1;
 			double shortest_tour = -1;
 
-			// Iterate over all vehicles
-			for (const auto& vehicle : vehicles) {
-				double tour_length = 2.0 * euclidean_distance(target.location, vehicle.depot_location);
-
-				// Update closest vehicle
-				if (closest_vehicle_id == -1 || tour_length < shortest_tour) {
-					closest_vehicle_id = vehicle.id;
-					shortest_tour = tour_length;
-				}
+			// Closest vehicle by squared distance (no square roots), then its tour length
+			if (vehicle_count(instance) > 0) {
+				closest_vehicle_id = nearest_point_index(location, instance.vehicle_x.data(), instance.vehicle_y.data(), vehicle_count(instance));
+				shortest_tour = 2.0 * oracle_distance(oracle, location, vehicle_location(instance, closest_vehicle_id));
 			}
 
 			// Write best singleton bid to file
-			auctions_outfile << closest_vehicle_id << " " << delivery_reward - shortest_tour << " " << target.id << std::endl;
+			auctions_outfile << closest_vehicle_id << " " << delivery_reward - shortest_tour << " " << target_id << std::endl;
 		}
 
 		// Iterate over all target pairs (for pair bids)
-		for (const auto& target_1 : targets) {
-			for (const auto& target_2 : targets) {
-				if (target_1.id > target_2.id) {
-					int closest_vehicle_id = -1;
-					double shortest_tour = -1;
-
-					// Iterate over all vehicles
-					for (const auto& vehicle : vehicles) {
-						double tour_length = euclidean_distance(target_1.location, target_2.location)
-									+ euclidean_distance(target_1.location, vehicle.depot_location)
-									+ euclidean_distance(target_2.location, vehicle.depot_location);
-
-						// Update closest vehicle
-						if (closest_vehicle_id == -1 || tour_length < shortest_tour) {
-							closest_vehicle_id = vehicle.id;
-							shortest_tour = tour_length;
-						}
+		for (int target_id_1 = 0; target_id_1 < num_goods; target_id_1++) {
+			std::pair<int, int> location_1 = target_location(instance, target_id_1);
+			for (int target_id_2 = 0; target_id_2 < target_id_1; target_id_2++) {
+				std::pair<int, int> location_2 = target_location(instance, target_id_2);
+				double pair_distance = oracle_distance(oracle, location_1, location_2);
+				int closest_vehicle_id = -1;
+				double shortest_tour = -1;
+
+				// Iterate over all vehicles
+				for (int vehicle_id = 0; vehicle_id < vehicle_count(instance); vehicle_id++) {
+					std::pair<int, int> depot_location = vehicle_location(instance, vehicle_id);
+					double tour_length = pair_distance
+								+ oracle_distance(oracle, location_1, depot_location)
+								+ oracle_distance(oracle, location_2, depot_location);
+
+					// Update closest vehicle
+					if (closest_vehicle_id == -1 || tour_length < shortest_tour) {
+						closest_vehicle_id = vehicle_id;
+						shortest_tour = tour_length;
 					}
-
-					// Write best pair bid to file
-					auctions_outfile << closest_vehicle_id << " " << 2 * delivery_reward - shortest_tour << " " << target_1.id << " " << target_2.id << std::endl;
 				}
+
+				// Write best pair bid to file
+				auctions_outfile << closest_vehicle_id << " " << 2 * delivery_reward - shortest_tour << " " << target_id_1 << " " << target_id_2 << std::endl;
 			}
 		}
 
@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <vector>
 #include "gurobi_c++.h"
+#include "../mip_start.h"
+#include "../solver_session.h"
 
 struct Bid {
     std::vector<int> bid_goods;
@@ -35,6 +37,7 @@ std::vector<Bid>        	bids_included_in_mwvc_by_kernalization;
 std::vector<Bid>        	bids_excluded_from_mwvc_by_kernalization;
 std::vector<Bid>        	bids_remaining_after_kernalization;
 std::vector<Edge>       	edges;
+SolverSession           	auction_session;	// Gurobi environment shared by the kernelization and MWVC solves of every auction
 
 /*
  * Resets auction state
@@ -131,13 +134,8 @@ void refactor_conflict_graph() {
  */
 void kernalize() {
     try {
-        // Create new environment and suppress output
-        GRBEnv* env = new GRBEnv();
-        env -> set(GRB_IntParam_OutputFlag, 0);
-
-        // Create new model
-        GRBModel model = GRBModel(*env);
-        model.set(GRB_StringAttr_ModelName, "kernelization");
+        // Create new model from the shared solver session
+        GRBModel model = session_model(auction_session, "kernelization");
 
         std::vector<GRBVar> bidVars;
 
@@ -163,7 +161,7 @@ void kernalize() {
         }
 
         // Solve
-        model.optimize();
+        optimize_in_session(auction_session, model);
 
         // Reconfigure bid vectors based on kernalization results
         for (int i = 0; i < num_original_bids; i++) {
@@ -216,13 +214,8 @@ void kernalize() {
  */
 void gurobi_mwvc_solve(std::string dataset_name_line, std::string winners_file_name) {
     try {
-        // Create new environment and suppress output
-        GRBEnv* env = new GRBEnv();
-        env -> set(GRB_IntParam_OutputFlag, 0);
-
-        // Create new model
-        GRBModel model = GRBModel(*env);
-        model.set(GRB_StringAttr_ModelName, "gurobi_mwvc");
+        // Create new model from the shared solver session
+        GRBModel model = session_model(auction_session, "gurobi_mwvc");
 
         std::vector<GRBVar> bidVars;
 
@@ -253,8 +246,33 @@ void gurobi_mwvc_solve(std::string dataset_name_line, std::string winners_file_n
 			model.addConstr(bidVars[bid_id_to_index[edge.v1]] + bidVars[bid_id_to_index[edge.v2]] >= 1.0f, "");
         }
 
-        // Solve
-        model.optimize();
+        // Warm start: the bids outside a greedy maximal-weight independent set form a vertex cover
+        model.update();
+        double* objCoeffs = model.get(GRB_DoubleAttr_Obj, bidVars.data(), bidVars.size());
+        std::vector<double> bidWeights(objCoeffs, objCoeffs + bidVars.size());
+        delete[] objCoeffs;
+
+        std::vector<std::pair<int, int>> bidConflicts;
+        for (Edge& edge : edges) {
+            bidConflicts.push_back(std::make_pair(bid_id_to_index[edge.v1], bid_id_to_index[edge.v2]));
+        }
+
+        std::vector<char> independentBids;
+        double independentWeight = greedy_independent_set(bidWeights, bidConflicts, independentBids);
+        double greedyCoverWeight = -independentWeight;
+        for (int i = 0; i < num_remaining_bids; i++) {
+            greedyCoverWeight += bidWeights[i];
+            independentBids[i] = !independentBids[i];
+        }
+        set_mip_start(model, bidVars, independentBids);
+
+        // Solve, timing the first incumbent
+        IncumbentTimer incumbentTimer;
+        model.setCallback(&incumbentTimer);
+        optimize_in_session(auction_session, model);
+        model.setCallback(NULL);
+        std::cout << "Greedy start: " << greedyCoverWeight << ", first incumbent: " << incumbentTimer.first_incumbent_objective
+                  << " at " << incumbentTimer.first_incumbent_seconds << " s" << std::endl;
 
 		// std::cout << std::endl;
 		// std::cout << bidVar.size() << std::endl;
@@ -339,6 +357,8 @@ void winner_determination(std::string auctions_file_name, std::string winners_fi
 
     if (infile.is_open()) {
     	std::string dataset_name_line;
+    	SolverSessionStats session_stats_before = auction_session.stats;
+    	int num_auctions = 0;
     	
     	// Read auctions iteratively
         while (std::getline(infile, dataset_name_line)) {
@@ -389,11 +409,15 @@ void winner_determination(std::string auctions_file_name, std::string winners_fi
 
 		    // Solve auction and output results
 	        gurobi_mwvc_solve(dataset_name_line, winners_file_name);
+	        num_auctions++;
 
 	        // Consume newline character
 	        std::getline(infile, line);
         }
 
         infile.close();
+
+        // Report the solver overhead per auction
+        print_session_overhead(auction_session.stats, session_stats_before, num_auctions);
     }
 }